@@ -8,6 +8,16 @@
 #include <ostream>
 #include <string>
 #include "matrix.h"
+#include "trojkatna.h"
+#include "wzorcowa.h"
+#include "pamiec.h"
+#include "metryki.h"
+#include "harmonogram.h"
+#include "splot.h"
+#include "tablica_sum.h"
+#include "strojenie.h"
+#include "wspolna.h"
+#include "skompresowana.h"
 using namespace std;
 
 /**
@@ -16,6 +26,9 @@ using namespace std;
  */
 int main()
 {
+#ifdef METRYKI
+    wlacz_slad(true);
+#endif
     int* tablica = new int[9];
     tablica[0] = 1;
     tablica[1] = 2;
@@ -35,6 +48,9 @@ int main()
 
     m1.alokuj(3);
     m2.alokuj(2);
+    cout << "m2 po alokuj(2): rozmiar bufora " << m2.pojemnosc() << endl;
+    m2.dopasuj_pojemnosc();
+    cout << "m2 po dopasuj_pojemnosc: rozmiar bufora " << m2.pojemnosc() << endl;
     m1.wstaw(2, 1, 45);
     cout << "Wynik działania metodu wstaw i pokaz:" << endl;
     cout << m1.pokaz(2, 1) << endl;
@@ -120,6 +136,197 @@ int main()
     cout << m9;
     cout << endl;
 
+    matrix m12(3, tablica);
+    m12.potega(5);
+    cout << "m12^5:" << endl;
+    cout << m12;
+    cout << endl;
+
+    matrix m13(3, tablica);
+    m13.potega(1000000, 1000007);
+    cout << "m13^1000000 mod 1000007:" << endl;
+    cout << m13;
+    cout << endl;
+
+    matrix m14(3, tablica);
+    m14.gemm(m12, m3, 2, 1, 5);
+    cout << "m14 = 2*m12*m3 + m14 + 5:" << endl;
+    cout << m14;
+    cout << endl;
+
+    matrix m15(3, tablica);
+    m15.mnoz<nasycanie>(1000000000);
+    cout << "m15*1000000000 z nasyceniem:" << endl;
+    cout << m15;
+    cout << endl;
+
+    matrix m16(3, tablica);
+    m16.mnoz<sprawdzanie>(1000000000);
+    cout << "m16*1000000000 ze sprawdzaniem, przepelnienie: " << (m16.przepelnienie() ? "true" : "false") << endl;
+    cout << endl;
+
+    int x, y;
+    int najwieksza = m12.argmax(x, y);
+    cout << "redukcje m12: suma " << m12.suma() << ", min " << m12.minimum() << ", max " << najwieksza;
+    cout << " w (" << x << ", " << y << "), slad " << m12.slad() << ", norma Frobeniusa " << m12.norma_frobeniusa();
+    cout << ", norma L1 " << m12.norma_1() << ", norma Linf " << m12.norma_inf() << endl;
+    cout << endl;
+
+    int wycinek[4];
+    m12.pobierz_blok(1, 1, 2, 2, wycinek);
+    matrix m17(3);
+    m17.przekatna();
+    m17.blok(0, 0, 2, 2, wycinek);
+    m17.wiersz(2, span<const int>(tablica, 3));
+    cout << "m17 z blokiem m12 i wierszem z tablicy:" << endl;
+    cout << m17;
+    cout << endl;
+
+    macierz_trojkatna t1(3, DOLNY, PRZEKATNA_JEDNOSTKOWA, 1);
+    matrix m18(3, tablica);
+    t1.mnoz_z_lewej(m18);
+    cout << "sumy prefiksowe kolumn m18 (trojkatna dolna z jedynkami * m18):" << endl;
+    cout << m18;
+    cout << endl;
+
+    t1.rozwiaz(m18);
+    cout << "m18 po rozwiazaniu ukladu z ta sama macierza trojkatna:" << endl;
+    cout << m18;
+    cout << endl;
+
+    macierz_wzorcowa szachownica(3, WZOR_SZACHOWNICA);
+    matrix m19(3, tablica);
+    szachownica.mnoz_z_prawej(m19);
+    szachownica.dodaj_do(m19);
+    cout << "m19*szachownica+szachownica (bez materializacji szachownicy):" << endl;
+    cout << m19;
+    cout << endl;
+
+    matrix m20(m19);
+    cout << "m20 jako kopia m19 wspoldzieli bufor: " << (m20.wspoldzielona() ? "true" : "false") << endl;
+    m20.wstaw(0, 0, 0);
+    cout << "po wstaw m20 wspoldzieli bufor: " << (m20.wspoldzielona() ? "true" : "false") << endl;
+    cout << endl;
+
+    ustaw_polityke_numa(NUMA_BLOKI_WIERSZY);
+    matrix m21(512);
+    m21.szachownica();
+    cout << "wezly NUMA: " << liczba_wezlow_numa() << ", suma szachownicy 512x512 z buforem NUMA_BLOKI_WIERSZY: " << m21.suma() << endl;
+    ustaw_polityke_numa(NUMA_BRAK);
+
+    const char* sposoby[] = { "sterta", "mapowanie", "THP", "hugetlb", "wspolny" };
+    matrix m22(1024);
+    m22.przekatna();
+    statystyki_pamieci sp = pobierz_statystyki_pamieci();
+    cout << "bufor 1024x1024: " << sposoby[m22.przydzial()] << ", slad " << m22.slad()
+        << ", przydzialy THP: " << sp.przydzialy[PRZYDZIAL_THP] << ", bez duzych stron: " << sp.nieudane_duze_strony << endl;
+
+    harmonogram h;
+    przyszla_macierz fa = h.wypelnij(64, WZOR_SZACHOWNICA);
+    przyszla_macierz fb = h.wypelnij(64, WZOR_PRZEKATNA);
+    przyszla_macierz fc = h.dodaj(h.mnoz(fa, h.mnoz(fb, 3)), h.dowroc(fa));
+    cout << "graf zadan: suma (A * 3I + A^T) = " << fc.pobierz().suma() << endl;
+
+    int wektor_x[4] = { 1, 2, 3, 4 };
+    int wektor_y[4];
+    matrix m23(4);
+    m23.nad_przekatna();
+    m23.mnoz_wektor(wektor_x, wektor_y);
+    cout << "m23 * x: " << wektor_y[0] << " " << wektor_y[1] << " " << wektor_y[2] << " " << wektor_y[3] << endl;
+    m23.mnoz_wektor_z_lewej(wektor_x, wektor_y);
+    cout << "x^T * m23: " << wektor_y[0] << " " << wektor_y[1] << " " << wektor_y[2] << " " << wektor_y[3] << endl;
+
+    matrix m24(2);
+    m24.szachownica();
+    matrix m25(2);
+    m25.przekatna();
+    m25 * 3;
+    matrix m26;
+    m26.iloczyn_kroneckera(m24, m25);
+    cout << "m24 (x) m25:" << endl << m26 << endl;
+    m24.maksimum_elementow(m25).hadamard(m25);
+    cout << "max(m24, m25) o m25:" << endl << m24 << endl;
+
+    matrix m27(6);
+    m27.szachownica();
+    matrix m28;
+    szablon_splotu::sasiedzi(BRZEG_ZAWIJANIE).zastosuj(m27, m28);
+    cout << "sasiedzi szachownicy (torus):" << endl << m28 << endl;
+    m27.przekatna();
+    m27 * 64;
+    szablon_splotu::rozmycie_3x3().iteruj(m27, 2);
+    cout << "przekatna * 64 po 2 krokach rozmycia:" << endl << m27 << endl;
+
+    tablica_sum sumy28(m28);
+    cout << "suma m28: " << sumy28.suma(0, 0, 6, 6) << ", blok 2 x 3 od (1, 2): " << sumy28.suma(1, 2, 2, 3) << endl;
+    sumy28.wstaw(1, 2, 100);
+    int wiersz28[6] = { 1, 1, 1, 1, 1, 1 };
+    sumy28.wiersz(0, wiersz28);
+    cout << "po wstaw(1, 2, 100) i wierszu jedynek: " << sumy28.suma(0, 0, 6, 6) << ", blok: " << sumy28.suma(1, 2, 2, 3) << endl;
+
+    matrix m29(3);
+    int wartosci29[9] = { 2, -1, 0, -1, 2, -1, 0, -1, 2 };
+    for (int i = 0; i < 9; i++)
+    {
+        m29.wstaw(i / 3, i % 3, wartosci29[i]);
+    }
+    cout << "wyznacznik m29: " << m29.wyznacznik() << ", rzad: " << m29.rzad() << ", odwracalna: " << m29.odwracalna() << endl;
+    m29 * 10000000;
+    cout << "wyznacznik m29 * 10^7: " << m29.wyznacznik() << endl;
+    cout << "rzad m28: " << m28.rzad() << endl;
+
+    matrix m29b(m29);
+    m29b.potega(3, 1000);
+    bool strojenie29 = stroj("");
+    matrix m29c(m29);
+    m29c.potega(3, 1000);
+    cout << "strojenie bez pliku podrecznego: " << strojenie29 << ", wynik potegi bez zmian: " << (m29b == m29c) << endl;
+
+    konfiguracja_jader k44 = konfiguracja(64);
+    int krance44[3][4] = { { 32767, -32767, -32767, 32767 }, { 255, 0, -128, 127 }, { -128, 127, -128, 127 } };
+    const char* nazwy44[3] = { "int16", "uint8 x int8", "int8 x int8" };
+    for (int s = 0; s < 3; s++)
+    {
+        matrix a44(64);
+        matrix b44(64);
+        for (int i = 0; i < 64; i++)
+        {
+            for (int j = 0; j < 64; j++)
+            {
+                a44.wstaw(i, j, krance44[s][(i * 7 + j) % 2]);
+                b44.wstaw(i, j, krance44[s][2 + (i + j * 5) % 2]);
+            }
+        }
+        matrix w8 = a44;
+        ustaw_konfiguracje(klasa_rozmiaru(64), { k44.pas_mnozenia, k44.kafelek_transpozycji, k44.watki, SCIEZKA_8 });
+        w8.mnoz<zawijanie>(b44);
+        matrix w32 = a44;
+        ustaw_konfiguracje(klasa_rozmiaru(64), { k44.pas_mnozenia, k44.kafelek_transpozycji, k44.watki, SCIEZKA_32 });
+        w32.mnoz<zawijanie>(b44);
+        cout << "pakowanie " << nazwy44[s] << " (skrajne wartosci) zgodne z 32 bitami: " << (w8 == w32) << endl;
+    }
+    ustaw_konfiguracje(klasa_rozmiaru(64), k44);
+
+    wydawca_macierzy wydawca30("zad4_m30");
+    czytelnik_macierzy czytelnik30("zad4_m30");
+    matrix m30;
+    wydawca30.opublikuj(m28);
+    czytelnik30.dolacz(m30);
+    cout << "m30 z pamieci wspoldzielonej: wersja " << czytelnik30.wersja() << ", bufor " << sposoby[m30.przydzial()]
+        << ", suma " << m30.suma() << endl;
+    wydawca30.opublikuj(m29);
+    cout << "po ponownej publikacji: wersja " << czytelnik30.wersja() << ", m30 nadal ma sume " << m30.suma() << endl;
+    m30 + 1;
+    cout << "m30 + 1 (prywatna kopia): bufor " << sposoby[m30.przydzial()] << ", suma " << m30.suma() << endl;
+    wydawca30.usun();
+
+    matrix m31(512);
+    m31.losuj();
+    macierz_skompresowana s31(m31);
+    cout << "m31 512x512 skompresowana: " << s31.bajty() << " B zamiast " << 512 * 512 * sizeof(int) << " B, suma " << s31.suma()
+        << " (gesta " << m31.suma() << "), rowna: " << s31.rowna(m31) << endl;
+    cout << endl;
+
     m7 + 5;
     cout << "m7+5:" << endl;
     cout << m7;
@@ -206,6 +413,18 @@ int main()
     cout << "m9>m10: " << name2 << endl;
     cout << "m9<m10: " << name3 << endl;
 
+#ifdef METRYKI
+    statystyki_operacji so[LICZBA_OPERACJI];
+    pobierz_metryki(so);
+    for (int i = 0; i < LICZBA_OPERACJI; i++)
+    {
+        cout << nazwa_operacji((operacja)i) << ": " << so[i].wywolania << " wywolan, " << so[i].czas_ns / 1000 << " us, "
+            << so[i].przydzialy << " przydzialow" << endl;
+    }
+    ofstream slad("slad.json");
+    eksportuj_slad_chrome(slad);
+#endif
+
     delete[] tablica;
     return 0;
 }
\ No newline at end of file
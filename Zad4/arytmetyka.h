@@ -0,0 +1,169 @@
+#pragma once
+#include <climits>
+
+/**
+ * @file arytmetyka.h
+ * @brief Polityki arytmetyki cakowitoliczbowej wybierane parametrem szablonu metod klasy matrix.
+ *
+ * Kada polityka okrela typ akumulatora mnoenia macierzy oraz sposb zawenia
+ * dokadnego wyniku do int. Funkcje nie zawieraj rozgazie, dziki czemu ptle
+ * je wywoujce mog by wektoryzowane.
+ */
+
+/**
+ * @struct suma_szeroka
+ * @brief Dokadna suma iloczynw liczb int w 128 bitach (starsze sowo ze znakiem, modsze bez znaku).
+ * Suma n iloczynw moe przekroczy zakres long long ju dla n = 2 (INT_MIN * INT_MIN = 2^62).
+ */
+struct suma_szeroka {
+    unsigned long long mlodsze = 0; ///< Modsze 64 bity sumy.
+    long long starsze = 0; ///< Starsze 64 bity sumy.
+
+    /**
+     * @brief Dodaje liczb do sumy, przenoszc nadmiar do starszego sowa.
+     * @param x Skadnik.
+     */
+    void dodaj(long long x)
+    {
+        unsigned long long m = mlodsze + (unsigned long long)x;
+        starsze += (long long)(m < mlodsze) - (long long)(x < 0);
+        mlodsze = m;
+    }
+
+    /**
+     * @brief Zwraca sum nasycon do zakresu long long.
+     * @return Suma, gdy mieci si w long long; w przeciwnym razie LLONG_MIN lub LLONG_MAX.
+     */
+    long long wartosc(void) const
+    {
+        bool miesci = starsze == -(long long)(mlodsze >> 63);
+        return miesci ? (long long)mlodsze : (starsze < 0 ? LLONG_MIN : LLONG_MAX);
+    }
+};
+
+/**
+ * @struct zawijanie
+ * @brief Arytmetyka modulo 2^32 (zachowanie zdefiniowane, bez wykrywania przepenienia).
+ */
+struct zawijanie {
+    typedef unsigned int akumulator; ///< Akumulator mnoenia macierzy (zawija modulo 2^32).
+
+    /**
+     * @brief Zawa wynik do int, obcinajc starsze bity.
+     * @param x Dokadny wynik operacji.
+     * @param blad Znacznik przepenienia (nieuywany).
+     * @return Wynik modulo 2^32.
+     */
+    static int zwez(long long x, [[maybe_unused]] int& blad)
+    {
+        return (int)(unsigned int)x;
+    }
+
+    /**
+     * @brief Dodaje iloczyn do akumulatora.
+     * @param s Akumulator.
+     * @param a Pierwszy czynnik.
+     * @param b Drugi czynnik.
+     */
+    static void dodaj_iloczyn(akumulator& s, int a, int b)
+    {
+        s += (unsigned int)a * (unsigned int)b;
+    }
+
+    /**
+     * @brief Zawa akumulator do int.
+     * @param s Akumulator.
+     * @param blad Znacznik przepenienia (nieuywany).
+     * @return Suma modulo 2^32.
+     */
+    static int zwez_sume(const akumulator& s, [[maybe_unused]] int& blad)
+    {
+        return (int)s;
+    }
+};
+
+/**
+ * @struct nasycanie
+ * @brief Arytmetyka z nasyceniem do przedziau [INT_MIN, INT_MAX].
+ */
+struct nasycanie {
+    typedef suma_szeroka akumulator; ///< Akumulator mnoenia macierzy (dokadny, 128 bitw).
+
+    /**
+     * @brief Zawa wynik do int, obcinajc go do granic typu.
+     * @param x Dokadny wynik operacji.
+     * @param blad Znacznik przepenienia (nieuywany).
+     * @return Wynik nasycony do zakresu int.
+     */
+    static int zwez(long long x, [[maybe_unused]] int& blad)
+    {
+        return (int)(x < INT_MIN ? INT_MIN : (x > INT_MAX ? INT_MAX : x));
+    }
+
+    /**
+     * @brief Dodaje iloczyn do akumulatora.
+     * @param s Akumulator.
+     * @param a Pierwszy czynnik.
+     * @param b Drugi czynnik.
+     */
+    static void dodaj_iloczyn(akumulator& s, int a, int b)
+    {
+        s.dodaj((long long)a * b);
+    }
+
+    /**
+     * @brief Zawa akumulator do int z nasyceniem.
+     * @param s Akumulator.
+     * @param blad Znacznik przepenienia (nieuywany).
+     * @return Suma nasycona do zakresu int.
+     */
+    static int zwez_sume(const akumulator& s, int& blad)
+    {
+        return zwez(s.wartosc(), blad);
+    }
+};
+
+/**
+ * @struct sprawdzanie
+ * @brief Arytmetyka sprawdzajca: wynik jak przy zawijaniu, a przepenienie ustawia znacznik.
+ */
+struct sprawdzanie {
+    typedef suma_szeroka akumulator; ///< Akumulator mnoenia macierzy (dokadny, 128 bitw).
+
+    /**
+     * @brief Zawa wynik do int i dopisuje przepenienie do znacznika.
+     * @param x Dokadny wynik operacji.
+     * @param blad Znacznik przepenienia (sumowany logicznie w caej ptli).
+     * @return Wynik modulo 2^32.
+     */
+    static int zwez(long long x, int& blad)
+    {
+        blad |= (x < INT_MIN) | (x > INT_MAX);
+        return (int)(unsigned int)x;
+    }
+
+    /**
+     * @brief Dodaje iloczyn do akumulatora.
+     * @param s Akumulator.
+     * @param a Pierwszy czynnik.
+     * @param b Drugi czynnik.
+     */
+    static void dodaj_iloczyn(akumulator& s, int a, int b)
+    {
+        s.dodaj((long long)a * b);
+    }
+
+    /**
+     * @brief Zawa akumulator do int i dopisuje przepenienie do znacznika.
+     * Suma nasycona do long long ley poza zakresem int wtedy i tylko wtedy, gdy dokadna suma te.
+     * @param s Akumulator.
+     * @param blad Znacznik przepenienia.
+     * @return Suma modulo 2^32.
+     */
+    static int zwez_sume(const akumulator& s, int& blad)
+    {
+        long long x = s.wartosc();
+        blad |= (x < INT_MIN) | (x > INT_MAX);
+        return (int)(unsigned int)s.mlodsze;
+    }
+};
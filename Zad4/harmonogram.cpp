@@ -0,0 +1,438 @@
+#include "harmonogram.h"
+#include <iostream>
+#include "watki.h"
+using namespace std;
+
+/**
+ * @struct wezel_zadania
+ * @brief Węzeł grafu operacji: operacja, jej wejścia, wynik i odbiorcy czekający na wynik.
+ */
+struct wezel_zadania {
+    function<matrix(vector<matrix>&)> praca; ///< Operacja (zwalniana po wykonaniu).
+    vector<shared_ptr<wezel_zadania>> wejscia; ///< Wejścia (zwalniane po wykonaniu).
+    atomic<int> brakujace{ 0 }; ///< Liczba niegotowych wejść.
+    mutex blokada; ///< Chroni pola poniżej.
+    condition_variable gotowy; ///< Sygnalizuje obliczenie wyniku.
+    bool zakonczony = false; ///< Czy wynik jest gotowy.
+    matrix wynik; ///< Wynik operacji.
+    vector<shared_ptr<wezel_zadania>> odbiorcy; ///< Węzły czekające na ten wynik.
+    vector<coroutine_handle<>> kontynuacje; ///< Korutyny czekające na ten wynik.
+};
+
+/**
+ * @brief Harmonogram, którego wątkiem jest bieżący wątek (nullptr poza harmonogramem).
+ */
+static thread_local harmonogram* biezacy_harmonogram = nullptr;
+
+/**
+ * @brief Numer bieżącego wątku w jego harmonogramie.
+ */
+static thread_local int numer_watku = -1;
+
+/**
+ * @brief Tworzy uchwyt węzła.
+ * @param w Węzeł grafu.
+ */
+przyszla_macierz::przyszla_macierz(shared_ptr<wezel_zadania> w) : wezel(w)
+{
+}
+
+/**
+ * @brief Tworzy pusty uchwyt.
+ */
+przyszla_macierz::przyszla_macierz(void)
+{
+}
+
+/**
+ * @brief Sprawdza, czy wynik jest już obliczony.
+ * @return true jeśli wynik jest gotowy.
+ */
+bool przyszla_macierz::gotowa(void) const
+{
+    if (wezel == nullptr)
+    {
+        return true;
+    }
+    lock_guard<mutex> l(wezel->blokada);
+    return wezel->zakonczony;
+}
+
+/**
+ * @brief Czeka na wynik.
+ * Nie należy wywoływać z wnętrza zadania harmonogramu - zależności wyraża się wejściami węzła.
+ */
+void przyszla_macierz::czekaj(void) const
+{
+    if (wezel == nullptr)
+    {
+        return;
+    }
+    unique_lock<mutex> l(wezel->blokada);
+    wezel->gotowy.wait(l, [&] { return wezel->zakonczony; });
+}
+
+/**
+ * @brief Czeka na wynik i zwraca go.
+ * Zwracana macierz współdzieli bufor z wynikiem węzła do pierwszego zapisu.
+ * @return Wynik operacji (pusta macierz dla pustego uchwytu).
+ */
+matrix przyszla_macierz::pobierz(void) const
+{
+    if (wezel == nullptr)
+    {
+        return matrix();
+    }
+    unique_lock<mutex> l(wezel->blokada);
+    wezel->gotowy.wait(l, [&] { return wezel->zakonczony; });
+    return wezel->wynik;
+}
+
+/**
+ * @brief Sprawdza, czy co_await może od razu zwrócić wynik.
+ * @return true jeśli wynik jest gotowy.
+ */
+bool przyszla_macierz::await_ready(void) const
+{
+    return gotowa();
+}
+
+/**
+ * @brief Zawiesza korutynę do czasu obliczenia wyniku.
+ * Korutyna jest wznawiana jako osobne zadanie w kolejce wątku harmonogramu, który zakończył węzeł,
+ * więc działa bez dzielenia pracy między wątki puli. Nie powinna czekać blokująco (czekaj, pobierz)
+ * na niegotowe węzły - przy jednym wątku harmonogramu byłoby to zakleszczenie; kolejne wyniki
+ * należy odbierać przez co_await.
+ * @param h Uchwyt korutyny.
+ * @return false jeśli wynik zdążył być gotowy i korutyna nie musi czekać.
+ */
+bool przyszla_macierz::await_suspend(coroutine_handle<> h) const
+{
+    if (wezel == nullptr)
+    {
+        return false;
+    }
+    lock_guard<mutex> l(wezel->blokada);
+    if (wezel->zakonczony)
+    {
+        return false;
+    }
+    wezel->kontynuacje.push_back(h);
+    return true;
+}
+
+/**
+ * @brief Zwraca wynik po wznowieniu korutyny.
+ * @return Wynik operacji.
+ */
+matrix przyszla_macierz::await_resume(void) const
+{
+    return pobierz();
+}
+
+/**
+ * @brief Uruchamia wątki harmonogramu.
+ * @param liczba Liczba wątków (0 - tyle, ile wątków ma pula z watki.h).
+ */
+harmonogram::harmonogram(int liczba)
+{
+    if (liczba <= 0)
+    {
+        liczba = liczba_watkow();
+    }
+    for (int t = 0; t < liczba; t++)
+    {
+        kolejki.push_back(make_unique<kolejka_zadan>());
+    }
+    for (int t = 0; t < liczba; t++)
+    {
+        watki.push_back(thread(&harmonogram::petla, this, t));
+    }
+}
+
+/**
+ * @brief Czeka na wszystkie zlecone zadania i zatrzymuje wątki.
+ */
+harmonogram::~harmonogram(void)
+{
+    czekaj();
+    {
+        lock_guard<mutex> l(blokada);
+        zamykanie = true;
+    }
+    praca.notify_all();
+    for (size_t i = 0; i < watki.size(); i++)
+    {
+        watki[i].join();
+    }
+}
+
+/**
+ * @brief Umieszcza gotowe zadanie w kolejce (własnej, jeśli wywołuje wątek harmonogramu).
+ * @param w Węzeł.
+ */
+void harmonogram::zlec(shared_ptr<wezel_zadania> w)
+{
+    int t = biezacy_harmonogram == this ? numer_watku : (int)(nastepna++ % kolejki.size());
+    {
+        lock_guard<mutex> l(kolejki[t]->blokada);
+        kolejki[t]->zadania.push_back(w);
+    }
+    {
+        lock_guard<mutex> l(blokada);
+        w_kolejkach++;
+    }
+    praca.notify_one();
+}
+
+/**
+ * @brief Pobiera zadanie z własnej kolejki lub kradnie je z innej.
+ * @param t Numer wątku.
+ * @param w Pobrany węzeł.
+ * @return true jeśli pobrano zadanie.
+ */
+bool harmonogram::pobierz_zadanie(int t, shared_ptr<wezel_zadania>& w)
+{
+    int K = (int)kolejki.size();
+    for (int i = 0; i < K && w == nullptr; i++)
+    {
+        kolejka_zadan& k = *kolejki[(t + i) % K];
+        lock_guard<mutex> l(k.blokada);
+        if (k.zadania.empty())
+        {
+            continue;
+        }
+        if (i == 0)
+        {
+            w = k.zadania.back();
+            k.zadania.pop_back();
+        }
+        else
+        {
+            w = k.zadania.front();
+            k.zadania.pop_front();
+        }
+    }
+    if (w == nullptr)
+    {
+        return false;
+    }
+    lock_guard<mutex> l(blokada);
+    w_kolejkach--;
+    return true;
+}
+
+/**
+ * @brief Wykonuje węzeł, zapisuje wynik i zleca odbiorców, którzy mają już wszystkie wejścia.
+ * Czekające korutyny są zlecane jako osobne zadania, a nie wznawiane wewnątrz węzła; trafiają
+ * do kolejki przed odbiorcami, więc wątek (pobierający od końca) najpierw wykonuje odbiorców.
+ * @param w Węzeł.
+ */
+void harmonogram::wykonaj(shared_ptr<wezel_zadania> w)
+{
+    vector<matrix> argumenty;
+    argumenty.reserve(w->wejscia.size());
+    for (size_t i = 0; i < w->wejscia.size(); i++)
+    {
+        argumenty.push_back(w->wejscia[i]->wynik);
+    }
+    matrix wynik = w->praca(argumenty);
+    argumenty.clear();
+    w->praca = nullptr;
+    w->wejscia.clear();
+
+    vector<shared_ptr<wezel_zadania>> odbiorcy;
+    vector<coroutine_handle<>> kontynuacje;
+    {
+        lock_guard<mutex> l(w->blokada);
+        w->wynik = wynik;
+        w->zakonczony = true;
+        odbiorcy.swap(w->odbiorcy);
+        kontynuacje.swap(w->kontynuacje);
+    }
+    w->gotowy.notify_all();
+    for (size_t i = 0; i < kontynuacje.size(); i++)
+    {
+        zadanie({}, [h = kontynuacje[i]](vector<matrix>&) {
+            h.resume();
+            return matrix();
+        });
+    }
+    for (size_t i = 0; i < odbiorcy.size(); i++)
+    {
+        if (--odbiorcy[i]->brakujace == 0)
+        {
+            zlec(odbiorcy[i]);
+        }
+    }
+    {
+        lock_guard<mutex> l(blokada);
+        niezakonczone--;
+    }
+    bezczynnosc.notify_all();
+}
+
+/**
+ * @brief Pętla wątku roboczego.
+ * @param t Numer wątku.
+ */
+void harmonogram::petla(int t)
+{
+    biezacy_harmonogram = this;
+    numer_watku = t;
+    wylacz_rownoleglosc_watku();
+    while (true)
+    {
+        shared_ptr<wezel_zadania> w;
+        if (pobierz_zadanie(t, w))
+        {
+            wykonaj(w);
+            continue;
+        }
+        unique_lock<mutex> l(blokada);
+        praca.wait(l, [&] { return zamykanie || w_kolejkach > 0; });
+        if (zamykanie && w_kolejkach == 0)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Zwraca gotowy węzeł z podaną macierzą.
+ * @param m Macierz (współdzielona do pierwszego zapisu).
+ * @return Uchwyt wyniku.
+ */
+przyszla_macierz harmonogram::stala(const matrix& m)
+{
+    shared_ptr<wezel_zadania> w = make_shared<wezel_zadania>();
+    w->wynik = m;
+    w->zakonczony = true;
+    return przyszla_macierz(w);
+}
+
+/**
+ * @brief Zleca dowolną operację wykonywaną po obliczeniu wejść.
+ * Funkcja dostaje kopie wyników wejść (współdzielące bufory), może je modyfikować i zwraca wynik.
+ * Węzeł jest rejestrowany u wejść z dodatkowym licznikiem, więc nie może zostać zlecony,
+ * zanim rejestracja się zakończy.
+ * @param wejscia Uchwyty wejść.
+ * @param f Operacja.
+ * @return Uchwyt wyniku (pusty, jeśli któreś wejście jest puste).
+ */
+przyszla_macierz harmonogram::zadanie(const vector<przyszla_macierz>& wejscia, function<matrix(vector<matrix>&)> f)
+{
+    for (size_t i = 0; i < wejscia.size(); i++)
+    {
+        if (wejscia[i].wezel == nullptr)
+        {
+            cout << "Puste wejscie zadania" << endl;
+            return przyszla_macierz();
+        }
+    }
+    shared_ptr<wezel_zadania> w = make_shared<wezel_zadania>();
+    w->praca = move(f);
+    w->brakujace = (int)wejscia.size() + 1;
+    {
+        lock_guard<mutex> l(blokada);
+        niezakonczone++;
+    }
+    for (size_t i = 0; i < wejscia.size(); i++)
+    {
+        wezel_zadania& we = *wejscia[i].wezel;
+        w->wejscia.push_back(wejscia[i].wezel);
+        lock_guard<mutex> l(we.blokada);
+        if (we.zakonczony)
+        {
+            w->brakujace--;
+        }
+        else
+        {
+            we.odbiorcy.push_back(w);
+        }
+    }
+    if (--w->brakujace == 0)
+    {
+        zlec(w);
+    }
+    return przyszla_macierz(w);
+}
+
+/**
+ * @brief Zleca mnożenie macierzy a * b.
+ * @param a Lewy czynnik.
+ * @param b Prawy czynnik.
+ * @return Uchwyt wyniku.
+ */
+przyszla_macierz harmonogram::mnoz(const przyszla_macierz& a, const przyszla_macierz& b)
+{
+    return zadanie({ a, b }, [](vector<matrix>& m) {
+        m[0] * m[1];
+        return m[0];
+    });
+}
+
+/**
+ * @brief Zleca dodawanie macierzy a + b.
+ * @param a Pierwszy składnik.
+ * @param b Drugi składnik.
+ * @return Uchwyt wyniku.
+ */
+przyszla_macierz harmonogram::dodaj(const przyszla_macierz& a, const przyszla_macierz& b)
+{
+    return zadanie({ a, b }, [](vector<matrix>& m) {
+        m[0] + m[1];
+        return m[0];
+    });
+}
+
+/**
+ * @brief Zleca transpozycję macierzy.
+ * @param a Macierz.
+ * @return Uchwyt wyniku.
+ */
+przyszla_macierz harmonogram::dowroc(const przyszla_macierz& a)
+{
+    return zadanie({ a }, [](vector<matrix>& m) {
+        m[0].dowroc();
+        return m[0];
+    });
+}
+
+/**
+ * @brief Zleca mnożenie macierzy przez liczbę.
+ * @param a Macierz.
+ * @param x Liczba.
+ * @return Uchwyt wyniku.
+ */
+przyszla_macierz harmonogram::mnoz(const przyszla_macierz& a, int x)
+{
+    return zadanie({ a }, [x](vector<matrix>& m) {
+        m[0] *= x;
+        return m[0];
+    });
+}
+
+/**
+ * @brief Zleca utworzenie macierzy n x n wypełnionej wzorcem.
+ * @param n Rozmiar macierzy.
+ * @param wzor Wzorzec.
+ * @return Uchwyt wyniku.
+ */
+przyszla_macierz harmonogram::wypelnij(int n, wzorzec wzor)
+{
+    return zadanie({}, [n, wzor](vector<matrix>&) {
+        matrix w(n);
+        macierz_wzorcowa(n, wzor).materializuj(w);
+        return w;
+    });
+}
+
+/**
+ * @brief Czeka, aż wszystkie zlecone zadania się zakończą.
+ */
+void harmonogram::czekaj(void)
+{
+    unique_lock<mutex> l(blokada);
+    bezczynnosc.wait(l, [&] { return niezakonczone == 0; });
+}
@@ -0,0 +1,221 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "matrix.h"
+#include "wzorcowa.h"
+using namespace std;
+
+/**
+ * @file harmonogram.h
+ * @brief Asynchroniczne operacje na macierzach tworzce graf zalenoci.
+ *
+ * Kada operacja zwraca od razu przyszla_macierz, a jej wykonanie czeka, a gotowe bd
+ * wszystkie wejcia. Niezalene wzy grafu wykonuj si rwnolegle na wtkach harmonogramu,
+ * ktre kradn sobie nawzajem zadania. Wze po wykonaniu zwalnia swoje wejcia, wic wynik
+ * poredni, do ktrego nie ma ju uchwytu, znika zaraz po zakoczeniu ostatniego odbiorcy.
+ */
+
+struct wezel_zadania;
+class harmonogram;
+
+/**
+ * @class przyszla_macierz
+ * @brief Uchwyt wyniku operacji asynchronicznej; mona na nim czeka lub uy go w co_await.
+ */
+class przyszla_macierz {
+private:
+    shared_ptr<wezel_zadania> wezel; ///< Wze grafu (nullptr dla pustego uchwytu).
+
+    friend class harmonogram;
+
+    /**
+     * @brief Tworzy uchwyt wza.
+     * @param w Wze grafu.
+     */
+    przyszla_macierz(shared_ptr<wezel_zadania> w);
+
+public:
+    /**
+     * @brief Tworzy pusty uchwyt.
+     */
+    przyszla_macierz(void);
+
+    /**
+     * @brief Sprawdza, czy wynik jest ju obliczony.
+     * @return true jeli wynik jest gotowy.
+     */
+    bool gotowa(void) const;
+
+    /**
+     * @brief Czeka na wynik.
+     * Nie naley wywoywa z wntrza zadania harmonogramu - zalenoci wyraa si wejciami wza.
+     */
+    void czekaj(void) const;
+
+    /**
+     * @brief Czeka na wynik i zwraca go.
+     * Zwracana macierz wspdzieli bufor z wynikiem wza do pierwszego zapisu.
+     * @return Wynik operacji (pusta macierz dla pustego uchwytu).
+     */
+    matrix pobierz(void) const;
+
+    /**
+     * @brief Sprawdza, czy co_await moe od razu zwrci wynik.
+     * @return true jeli wynik jest gotowy.
+     */
+    bool await_ready(void) const;
+
+    /**
+     * @brief Zawiesza korutyn do czasu obliczenia wyniku.
+     * Korutyna jest wznawiana jako osobne zadanie w kolejce wtku harmonogramu, ktry zakoczy wze,
+     * wic dziaa bez dzielenia pracy midzy wtki puli. Nie powinna czeka blokujco (czekaj, pobierz)
+     * na niegotowe wzy - przy jednym wtku harmonogramu byoby to zakleszczenie; kolejne wyniki
+     * naley odbiera przez co_await.
+     * @param h Uchwyt korutyny.
+     * @return false jeli wynik zdy by gotowy i korutyna nie musi czeka.
+     */
+    bool await_suspend(coroutine_handle<> h) const;
+
+    /**
+     * @brief Zwraca wynik po wznowieniu korutyny.
+     * @return Wynik operacji.
+     */
+    matrix await_resume(void) const;
+};
+
+/**
+ * @class harmonogram
+ * @brief Wtki wykonujce graf operacji asynchronicznych z kradzie zada.
+ * Kady wtek ma wasn kolejk: nowe gotowe zadania trafiaj na jej koniec i s stamtd
+ * pobierane (LIFO), a bezczynny wtek zabiera najstarsze zadanie z kolejki innego wtku.
+ */
+class harmonogram {
+private:
+    /**
+     * @struct kolejka_zadan
+     * @brief Kolejka gotowych zada jednego wtku.
+     */
+    struct kolejka_zadan {
+        mutex blokada; ///< Chroni kolejk.
+        deque<shared_ptr<wezel_zadania>> zadania; ///< Gotowe zadania.
+    };
+
+    vector<unique_ptr<kolejka_zadan>> kolejki; ///< Kolejki wtkw.
+    vector<thread> watki; ///< Wtki robocze.
+    mutex blokada; ///< Chroni liczniki i stan zamykania.
+    condition_variable praca; ///< Budzi wtki, gdy pojawi si zadania.
+    condition_variable bezczynnosc; ///< Sygnalizuje zakoczenie wszystkich zada.
+    long long w_kolejkach = 0; ///< Liczba zada w kolejkach.
+    long long niezakonczone = 0; ///< Liczba zleconych i jeszcze niezakoczonych zada.
+    bool zamykanie = false; ///< Czy harmonogram jest zamykany.
+    atomic<unsigned> nastepna{ 0 }; ///< Kolejka dla zadania zleconego spoza harmonogramu.
+
+    /**
+     * @brief Umieszcza gotowe zadanie w kolejce (wasnej, jeli wywouje wtek harmonogramu).
+     * @param w Wze.
+     */
+    void zlec(shared_ptr<wezel_zadania> w);
+
+    /**
+     * @brief Pobiera zadanie z wasnej kolejki lub kradnie je z innej.
+     * @param t Numer wtku.
+     * @param w Pobrany wze.
+     * @return true jeli pobrano zadanie.
+     */
+    bool pobierz_zadanie(int t, shared_ptr<wezel_zadania>& w);
+
+    /**
+     * @brief Wykonuje wze, zapisuje wynik i zleca odbiorcw, ktrzy maj ju wszystkie wejcia.
+     * Czekajce korutyny s zlecane jako osobne zadania, a nie wznawiane wewntrz wza.
+     * @param w Wze.
+     */
+    void wykonaj(shared_ptr<wezel_zadania> w);
+
+    /**
+     * @brief Ptla wtku roboczego.
+     * @param t Numer wtku.
+     */
+    void petla(int t);
+
+public:
+    /**
+     * @brief Uruchamia wtki harmonogramu.
+     * @param liczba Liczba wtkw (0 - tyle, ile wtkw ma pula z watki.h).
+     */
+    harmonogram(int liczba = 0);
+
+    /**
+     * @brief Czeka na wszystkie zlecone zadania i zatrzymuje wtki.
+     */
+    ~harmonogram(void);
+
+    harmonogram(const harmonogram&) = delete;
+    harmonogram& operator=(const harmonogram&) = delete;
+
+    /**
+     * @brief Zwraca gotowy wze z podan macierz.
+     * @param m Macierz (wspdzielona do pierwszego zapisu).
+     * @return Uchwyt wyniku.
+     */
+    przyszla_macierz stala(const matrix& m);
+
+    /**
+     * @brief Zleca dowoln operacj wykonywan po obliczeniu wej.
+     * Funkcja dostaje kopie wynikw wej (wspdzielce bufory), moe je modyfikowa i zwraca wynik.
+     * @param wejscia Uchwyty wej.
+     * @param f Operacja.
+     * @return Uchwyt wyniku (pusty, jeli ktre wejcie jest puste).
+     */
+    przyszla_macierz zadanie(const vector<przyszla_macierz>& wejscia, function<matrix(vector<matrix>&)> f);
+
+    /**
+     * @brief Zleca mnoenie macierzy a * b.
+     * @param a Lewy czynnik.
+     * @param b Prawy czynnik.
+     * @return Uchwyt wyniku.
+     */
+    przyszla_macierz mnoz(const przyszla_macierz& a, const przyszla_macierz& b);
+
+    /**
+     * @brief Zleca dodawanie macierzy a + b.
+     * @param a Pierwszy skadnik.
+     * @param b Drugi skadnik.
+     * @return Uchwyt wyniku.
+     */
+    przyszla_macierz dodaj(const przyszla_macierz& a, const przyszla_macierz& b);
+
+    /**
+     * @brief Zleca transpozycj macierzy.
+     * @param a Macierz.
+     * @return Uchwyt wyniku.
+     */
+    przyszla_macierz dowroc(const przyszla_macierz& a);
+
+    /**
+     * @brief Zleca mnoenie macierzy przez liczb.
+     * @param a Macierz.
+     * @param x Liczba.
+     * @return Uchwyt wyniku.
+     */
+    przyszla_macierz mnoz(const przyszla_macierz& a, int x);
+
+    /**
+     * @brief Zleca utworzenie macierzy n x n wypenionej wzorcem.
+     * @param n Rozmiar macierzy.
+     * @param wzor Wzorzec.
+     * @return Uchwyt wyniku.
+     */
+    przyszla_macierz wypelnij(int n, wzorzec wzor);
+
+    /**
+     * @brief Czeka, a wszystkie zlecone zadania si zakocz.
+     */
+    void czekaj(void);
+};
@@ -3,607 +3,2731 @@
 #include <ostream>
 #include <ctime>
 #include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include "watki.h"
+#include "pamiec.h"
+#include "metryki.h"
+#include "strojenie.h"
 using namespace std;
 
+/**
+ * @brief Alokuje macierz n x n jako jeden ciągły bufor i tablicę wskaźników na jego wiersze.
+ * Początek bufora to zawsze w[0], również dla n = 0. Przy polityce NUMA_BLOKI_WIERSZY
+ * bloki wierszy są zerowane równolegle przez wątki, które później je przetwarzają,
+ * więc strony trafiają do ich węzłów NUMA.
+ * @param n Rozmiar macierzy.
+ * @return Tablica wskaźników na wiersze.
+ */
+static int** nowe_wiersze(int n)
+{
+    int** w = new int* [n > 0 ? n : 1];
+    w[0] = przydziel_bufor(n > 0 ? (size_t)n * n : 1);
+    MIERZ_PRZYDZIAL((long long)n * n * sizeof(int));
+    for (int i = 1; i < n; i++) {
+        w[i] = w[0] + (size_t)i * n;
+    }
+    if (aktualna_polityka_numa() == NUMA_BLOKI_WIERSZY)
+    {
+        rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+            memset(w[poczatek], 0, (size_t)(koniec - poczatek) * n * sizeof(int));
+        });
+    }
+    return w;
+}
+
+/**
+ * @brief Zwalnia wiersze zaalokowane przez nowe_wiersze.
+ * @param w Tablica wskaźników na wiersze.
+ */
+static void zwolnij_wiersze(int** w)
+{
+    zwolnij_bufor(w[0]);
+    delete[] w;
+}
+
+#ifdef METRYKI
+/**
+ * @brief Szacuje liczbę bajtów, które operacja odczytuje i zapisuje.
+ * @param dlug Wskaźnik na rozmiar macierzy (może być nullptr).
+ * @param przebiegi Liczba przebiegów po macierzy n x n.
+ * @return Liczba bajtów.
+ */
+static long long bajty_macierzy(const int* dlug, int przebiegi)
+{
+    return dlug == nullptr ? 0 : (long long)*dlug * *dlug * sizeof(int) * przebiegi;
+}
+#endif
+
+/**
+ * @struct bufory_mnozenia
+ * @brief Bufory robocze jąder mnożenia, powiększane tylko w razie potrzeby.
+ * potega tworzy je raz i przekazuje do każdego kroku, więc kolejne mnożenia nie alokują pamięci.
+ * Wiersz sum bloku wierszy b zaczyna się od indeksu b * n.
+ */
+struct bufory_mnozenia {
+    vector<unsigned int> sumy; ///< Wiersze sum z zawijaniem modulo 2^32.
+    vector<suma_szeroka> sumy_szerokie; ///< Wiersze sum dokładnych (nasycanie i sprawdzanie).
+    vector<unsigned long long> sumy_modulo; ///< Wiersze sum mnożenia modulo.
+    vector<int> bledy; ///< Znaczniki przepełnienia bloków wierszy.
+    vector<int> najmniejsze; ///< Najmniejsze wartości bloków wierszy (zakres_wartosci).
+    vector<int> najwieksze; ///< Największe wartości bloków wierszy (zakres_wartosci).
+    vector<int16_t> a16; ///< Lewy czynnik spakowany do int16_t.
+    vector<int16_t> b16; ///< Prawy czynnik spakowany do int16_t (transponowany).
+    vector<uint8_t> a8; ///< Lewy czynnik spakowany do uint8_t.
+    vector<int8_t> b8; ///< Prawy czynnik spakowany do int8_t (transponowany).
+    vector<unsigned int> poprawka; ///< Poprawki kolumn wyniku za przesunięcie lewego czynnika.
+};
+
+/**
+ * @brief Zapewnia, że bufor ma co najmniej n elementów (nigdy go nie zmniejsza).
+ * @param v Bufor.
+ * @param n Wymagana liczba elementów.
+ * @return Wskaźnik na początek bufora.
+ */
+template <class T>
+static T* zapewnij(vector<T>& v, size_t n)
+{
+    if (v.size() < n)
+    {
+        v.resize(n);
+    }
+    return v.data();
+}
+
+/**
+ * @brief Zwraca bufor wierszy sum o elementach typu T.
+ * @tparam T Typ akumulatora.
+ * @param bufory Bufory robocze.
+ * @return Bufor wierszy sum.
+ */
+template <class T>
+static vector<T>& sumy_bufora(bufory_mnozenia& bufory)
+{
+    if constexpr (is_same_v<T, unsigned int>)
+    {
+        return bufory.sumy;
+    }
+    else if constexpr (is_same_v<T, suma_szeroka>)
+    {
+        return bufory.sumy_szerokie;
+    }
+    else
+    {
+        return bufory.sumy_modulo;
+    }
+}
+
+/**
+ * @brief Zwraca bufor lewego czynnika spakowanego do typu TA.
+ * @tparam TA Typ elementów (uint8_t lub int16_t).
+ * @param bufory Bufory robocze.
+ * @return Bufor lewego czynnika.
+ */
+template <class TA>
+static vector<TA>& lewy_bufora(bufory_mnozenia& bufory)
+{
+    if constexpr (is_same_v<TA, uint8_t>)
+    {
+        return bufory.a8;
+    }
+    else
+    {
+        return bufory.a16;
+    }
+}
+
+/**
+ * @brief Zwraca bufor prawego czynnika spakowanego do typu TB.
+ * @tparam TB Typ elementów (int8_t lub int16_t).
+ * @param bufory Bufory robocze.
+ * @return Bufor prawego czynnika.
+ */
+template <class TB>
+static vector<TB>& prawy_bufora(bufory_mnozenia& bufory)
+{
+    if constexpr (is_same_v<TB, int8_t>)
+    {
+        return bufory.b8;
+    }
+    else
+    {
+        return bufory.b16;
+    }
+}
+
+/**
+ * @struct bez_epilogu
+ * @brief Epilog zwykłego mnożenia: element wyniku to iloczyn a * b.
+ */
+struct bez_epilogu {
+    /**
+     * @brief Zwraca element wyniku.
+     * @param i Wiersz.
+     * @param j Kolumna.
+     * @param iloczyn Element iloczynu a * b.
+     * @return Element wyniku.
+     */
+    int operator()(int i, int j, int iloczyn) const
+    {
+        return iloczyn;
+    }
+};
+
+/**
+ * @struct epilog_gemm
+ * @brief Epilog gemm: element wyniku to alfa * iloczyn + beta * stary + przesuniecie (modulo 2^32).
+ * Stary element jest czytany tuż przed zapisem nowego, więc stare może wskazywać wiersze wyniku.
+ */
+struct epilog_gemm {
+    unsigned int alfa; ///< Mnożnik iloczynu.
+    unsigned int beta; ///< Mnożnik dotychczasowej zawartości.
+    unsigned int przesuniecie; ///< Liczba dodawana do każdego elementu.
+    int* const* stare; ///< Wiersze dotychczasowej zawartości.
+
+    /**
+     * @brief Zwraca element wyniku.
+     * @param i Wiersz.
+     * @param j Kolumna.
+     * @param iloczyn Element iloczynu a * b.
+     * @return Element wyniku.
+     */
+    int operator()(int i, int j, int iloczyn) const
+    {
+        return (int)(alfa * (unsigned int)iloczyn + beta * (unsigned int)stare[i][j] + przesuniecie);
+    }
+};
+
+/**
+ * @brief Mnoży macierze a i b z polityką arytmetyki P, zapisując wynik w c (c = a * b).
+ * Iloczyny są sumowane w akumulatorze P::akumulator (dla nasycania i sprawdzania dokładnym,
+ * 128-bitowym) i zawężane do int dopiero przy zapisie. Bloki wierszy są liczone równolegle,
+ * każdy z własnym wierszem sum i znacznikiem przepełnienia. Wiersz wyniku jest zapisywany
+ * przez epilog e, gdy cały wiersz a został już odczytany.
+ * @tparam P Polityka arytmetyki.
+ * @tparam E Typ epilogu.
+ * @param a Wiersze lewego czynnika (mogą pokrywać się z c).
+ * @param b Wiersze prawego czynnika (nie mogą pokrywać się z c).
+ * @param c Wiersze wyniku.
+ * @param n Rozmiar macierzy.
+ * @param blad Znacznik przepełnienia uzupełniany przez politykę.
+ * @param bufory Bufory robocze.
+ * @param e Epilog zapisu.
+ */
+template <class P, class E = bez_epilogu>
+static void mnoz_wiersze_p(int* const* a, int* const* b, int** c, int n, int& blad, bufory_mnozenia& bufory, const E& e = E())
+{
+    typedef typename P::akumulator akumulator;
+    int bloki = liczba_blokow(n);
+    akumulator* sumy = zapewnij(sumy_bufora<akumulator>(bufory), (size_t)bloki * n);
+    int* bledy = zapewnij(bufory.bledy, (size_t)bloki);
+    rownolegle(n, (long long)n * n * n, [&](int blok, int poczatek, int koniec) {
+        akumulator* suma = sumy + (size_t)blok * n;
+        int blad_bloku = 0;
+        for (int i = poczatek; i < koniec; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                suma[j] = akumulator();
+            }
+            for (int k = 0; k < n; k++)
+            {
+                int aik = a[i][k];
+                const int* bk = b[k];
+                for (int j = 0; j < n; j++)
+                {
+                    P::dodaj_iloczyn(suma[j], aik, bk[j]);
+                }
+            }
+            int* ci = c[i];
+            for (int j = 0; j < n; j++)
+            {
+                ci[j] = e(i, j, P::zwez_sume(suma[j], blad_bloku));
+            }
+        }
+        bledy[blok] = blad_bloku;
+    });
+    for (int i = 0; i < bloki; i++)
+    {
+        blad |= bledy[i];
+    }
+}
+
+/**
+ * @brief Wyznacza najmniejszą i największą wartość macierzy (bloki wierszy równolegle).
+ * @param a Wiersze macierzy.
+ * @param n Rozmiar macierzy (n > 0).
+ * @param najmniejsza Wynik: najmniejsza wartość.
+ * @param najwieksza Wynik: największa wartość.
+ * @param bufory Bufory robocze.
+ */
+static void zakres_wartosci(int* const* a, int n, int& najmniejsza, int& najwieksza, bufory_mnozenia& bufory)
+{
+    int bloki = liczba_blokow(n);
+    int* mn = zapewnij(bufory.najmniejsze, (size_t)bloki);
+    int* mx = zapewnij(bufory.najwieksze, (size_t)bloki);
+    rownolegle(n, (long long)n * n, [&](int b, int poczatek, int koniec) {
+        int lo = a[poczatek][0];
+        int hi = a[poczatek][0];
+        for (int i = poczatek; i < koniec; i++)
+        {
+            const int* w = a[i];
+            for (int j = 0; j < n; j++)
+            {
+                lo = w[j] < lo ? w[j] : lo;
+                hi = w[j] > hi ? w[j] : hi;
+            }
+        }
+        mn[b] = lo;
+        mx[b] = hi;
+    });
+    najmniejsza = *min_element(mn, mn + bloki);
+    najwieksza = *max_element(mx, mx + bloki);
+}
+
+/**
+ * @brief Mnoży macierze, których elementy mieszczą się w typach TA i TB (c = a * b, modulo 2^32).
+ * Czynniki są pakowane do wąskich typów (b transponowana), a element wyniku to iloczyn skalarny
+ * wiersza a i wiersza b^T sumowany w unsigned int. Kompilator zamienia tę pętlę na mnożenie
+ * par z sumowaniem do 32 bitów (pmaddwd, z VNNI vpdpwssd, a dla uint8_t x int8_t vpdpbusd).
+ * Elementy a mogą być przy pakowaniu przesunięte o stałą, by zmieściły się w TA; wynik jest
+ * wtedy poprawiany o przesuniecie * suma kolumny b. Kolumny wyniku są liczone pasami,
+ * by pas b^T był wspólny dla całego bloku wierszy.
+ * @tparam TA Typ elementów a.
+ * @tparam TB Typ elementów b.
+ * @tparam E Typ epilogu.
+ * @param a Wiersze lewego czynnika (mogą pokrywać się z c - są pakowane przed liczeniem).
+ * @param b Wiersze prawego czynnika (mogą pokrywać się z c - są pakowane przed liczeniem).
+ * @param c Wiersze wyniku.
+ * @param n Rozmiar macierzy.
+ * @param przesuniecie Stała dodawana do elementów a przy pakowaniu.
+ * @param k Konfiguracja jąder (szerokość pasa i liczba wątków).
+ * @param bufory Bufory robocze na spakowane czynniki i poprawki.
+ * @param e Epilog zapisu.
+ */
+template <class TA, class TB, class E>
+static void mnoz_wiersze_waskie(int* const* a, int* const* b, int** c, int n, int przesuniecie, const konfiguracja_jader& k, bufory_mnozenia& bufory, const E& e)
+{
+    int pas = k.pas_mnozenia;
+    TA* pa = zapewnij(lewy_bufora<TA>(bufory), (size_t)n * n);
+    TB* pb = zapewnij(prawy_bufora<TB>(bufory), (size_t)n * n);
+    unsigned int* poprawka = zapewnij(bufory.poprawka, (size_t)n);
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int i = poczatek; i < koniec; i++)
+        {
+            TA* w = &pa[(size_t)i * n];
+            for (int q = 0; q < n; q++)
+            {
+                w[q] = (TA)(a[i][q] + przesuniecie);
+            }
+        }
+        for (int q = 0; q < n; q++)
+        {
+            const int* w = b[q];
+            for (int j = poczatek; j < koniec; j++)
+            {
+                pb[(size_t)j * n + q] = (TB)w[j];
+            }
+        }
+        for (int j = poczatek; j < koniec; j++)
+        {
+            const TB* y = &pb[(size_t)j * n];
+            unsigned int suma = 0;
+            for (int q = 0; q < n && przesuniecie != 0; q++)
+            {
+                suma += (unsigned int)y[q];
+            }
+            poprawka[j] = suma * (unsigned int)przesuniecie;
+        }
+    }, k.watki);
+    rownolegle(n, (long long)n * n * n, [&](int blok, int poczatek, int koniec) {
+        for (int j0 = 0; j0 < n; j0 += pas)
+        {
+            int j1 = j0 + pas < n ? j0 + pas : n;
+            for (int i = poczatek; i < koniec; i++)
+            {
+                const TA* x = &pa[(size_t)i * n];
+                int* ci = c[i];
+                for (int j = j0; j < j1; j++)
+                {
+                    const TB* y = &pb[(size_t)j * n];
+                    unsigned int suma = 0;
+                    for (int q = 0; q < n; q++)
+                    {
+                        suma += (unsigned int)(x[q] * y[q]);
+                    }
+                    ci[j] = e(i, j, (int)(suma - poprawka[j]));
+                }
+            }
+        }
+    }, k.watki);
+}
+
+/**
+ * @brief Mnoży macierze z zawijaniem modulo 2^32 (c = a * b), wybierając typ elementów na podstawie ich zakresu.
+ * Gdy b mieści się w int8_t, a a w uint8_t lub int8_t (przesuniętym o 128), a konfiguracja
+ * dopuszcza SCIEZKA_8, używana jest ścieżka uint8_t x int8_t; gdy oba czynniki mieszczą się
+ * w int16_t, a konfiguracja dopuszcza co najmniej SCIEZKA_16 - ścieżka 16-bitowa; w przeciwnym
+ * razie 32-bitowa. Sprawdzenie zakresów kosztuje O(n^2) wobec O(n^3) mnożenia.
+ * Każda ścieżka zapisuje elementy wyniku przez epilog e.
+ * @tparam E Typ epilogu.
+ * @param a Wiersze lewego czynnika (mogą pokrywać się z c).
+ * @param b Wiersze prawego czynnika (nie mogą pokrywać się z c).
+ * @param c Wiersze wyniku.
+ * @param n Rozmiar macierzy.
+ * @param bufory Bufory robocze.
+ * @param e Epilog zapisu.
+ */
+template <class E = bez_epilogu>
+static void mnoz_wiersze_zawijanie(int* const* a, int* const* b, int** c, int n, bufory_mnozenia& bufory, const E& e = E())
+{
+    if (n == 0)
+    {
+        return;
+    }
+    konfiguracja_jader k = konfiguracja(n);
+    int a_min = 0, a_max = 0, b_min = 0, b_max = 0;
+    if (k.sciezka != SCIEZKA_32)
+    {
+        zakres_wartosci(a, n, a_min, a_max, bufory);
+        zakres_wartosci(b, n, b_min, b_max, bufory);
+    }
+    bool bajty = k.sciezka == SCIEZKA_8 && b_min >= INT8_MIN && b_max <= INT8_MAX;
+    if (bajty && a_min >= 0 && a_max <= UINT8_MAX)
+    {
+        mnoz_wiersze_waskie<uint8_t, int8_t>(a, b, c, n, 0, k, bufory, e);
+    }
+    else if (bajty && a_min >= INT8_MIN && a_max <= INT8_MAX)
+    {
+        mnoz_wiersze_waskie<uint8_t, int8_t>(a, b, c, n, 128, k, bufory, e);
+    }
+    else if (k.sciezka != SCIEZKA_32 && a_min >= INT16_MIN && a_max <= INT16_MAX && b_min >= INT16_MIN && b_max <= INT16_MAX)
+    {
+        mnoz_wiersze_waskie<int16_t, int16_t>(a, b, c, n, 0, k, bufory, e);
+    }
+    else
+    {
+        int blad = 0;
+        mnoz_wiersze_p<zawijanie>(a, b, c, n, blad, bufory, e);
+    }
+}
+
+/**
+ * @brief Mnoży macierze a i b, zapisując wynik w c (c = a * b), bloki wierszy równolegle.
+ * Pętla w kolejności i-k-j przechodzi wiersze b sekwencyjnie, co pozwala na wektoryzację.
+ * Bez modułu arytmetyka zawija modulo 2^32. Z modułem elementy czynników leżą w [0, modul),
+ * więc do sumy 64-bitowej bez znaku można dodać (2^64 - modul) / (modul - 1)^2 iloczynów,
+ * zanim trzeba ją zredukować; reszta z dzielenia jest liczona raz na tyle wyrazów.
+ * @param a Wiersze lewego czynnika (elementy z [0, modul) przy module różnym od 0).
+ * @param b Wiersze prawego czynnika (elementy z [0, modul) przy module różnym od 0).
+ * @param c Wiersze wyniku (nie mogą pokrywać się z a ani b).
+ * @param n Rozmiar macierzy.
+ * @param modul Moduł arytmetyki (0 - bez redukcji modulo).
+ * @param bufory Bufory robocze.
+ */
+static void mnoz_wiersze(int* const* a, int* const* b, int** c, int n, int modul, bufory_mnozenia& bufory)
+{
+    if (modul == 0)
+    {
+        mnoz_wiersze_zawijanie(a, b, c, n, bufory);
+        return;
+    }
+
+    unsigned long long m = (unsigned long long)modul;
+    unsigned long long max_iloczyn = (m - 1) * (m - 1);
+    int okres = n;
+    if (max_iloczyn != 0 && (ULLONG_MAX - (m - 1)) / max_iloczyn < (unsigned long long)n)
+    {
+        okres = (int)((ULLONG_MAX - (m - 1)) / max_iloczyn);
+    }
+    unsigned long long* sumy = zapewnij(bufory.sumy_modulo, (size_t)liczba_blokow(n) * n);
+    rownolegle(n, (long long)n * n * n, [&](int blok, int poczatek, int koniec) {
+        unsigned long long* suma = sumy + (size_t)blok * n;
+        for (int i = poczatek; i < koniec; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                suma[j] = 0;
+            }
+            for (int k0 = 0; k0 < n; k0 += okres)
+            {
+                int k1 = n - k0 > okres ? k0 + okres : n;
+                for (int k = k0; k < k1; k++)
+                {
+                    unsigned long long aik = (unsigned int)a[i][k];
+                    const int* bk = b[k];
+                    for (int j = 0; j < n; j++)
+                    {
+                        suma[j] += aik * (unsigned int)bk[j];
+                    }
+                }
+                for (int j = 0; j < n; j++)
+                {
+                    suma[j] %= m;
+                }
+            }
+            int* ci = c[i];
+            for (int j = 0; j < n; j++)
+            {
+                ci[j] = (int)suma[j];
+            }
+        }
+    });
+}
+
+/**
+ * @brief Mnoży macierz przez wektor (y = a * x), bloki wierszy równolegle.
+ * Każdy wiersz jest czytany raz, strumieniowo, a iloczyn skalarny liczony w arytmetyce
+ * bez znaku, którą kompilator wektoryzuje. Arytmetyka zawija modulo 2^32.
+ * @param a Wiersze macierzy.
+ * @param x Wektor n wartości.
+ * @param y Wynik (n wartości).
+ * @param n Rozmiar macierzy.
+ */
+static void gemv_wiersze(int* const* a, const int* x, int* y, int n)
+{
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int i = poczatek; i < koniec; i++)
+        {
+            const int* w = a[i];
+            unsigned int suma = 0;
+            for (int j = 0; j < n; j++)
+            {
+                suma += (unsigned int)w[j] * (unsigned int)x[j];
+            }
+            y[i] = (int)suma;
+        }
+    });
+}
+
+/**
+ * @brief Mnoży wektor wierszowy przez macierz (y^T = x^T * a).
+ * Bloki dzielą kolumny zamiast wierszy: każdy blok przechodzi po wszystkich wierszach,
+ * sumując swój pas WIERSZE_W_BLOKU kolumn w lokalnym buforze, więc bloki nie dzielą
+ * zapisywanej pamięci. Arytmetyka zawija modulo 2^32.
+ * @param a Wiersze macierzy.
+ * @param x Wektor n wartości.
+ * @param y Wynik (n wartości).
+ * @param n Rozmiar macierzy.
+ */
+static void gemv_kolumny(int* const* a, const int* x, int* y, int n)
+{
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        // rownolegle daje bloki o co najwyżej WIERSZE_W_BLOKU indeksach, więc pas mieści się w buforze.
+        unsigned int suma[WIERSZE_W_BLOKU] = { 0 };
+        int szer = koniec - poczatek;
+        for (int i = 0; i < n; i++)
+        {
+            unsigned int xi = x[i];
+            const int* w = a[i] + poczatek;
+            for (int j = 0; j < szer; j++)
+            {
+                suma[j] += xi * (unsigned int)w[j];
+            }
+        }
+        for (int j = 0; j < szer; j++)
+        {
+            y[poczatek + j] = (int)suma[j];
+        }
+    });
+}
+
+/**
+ * @brief Mnoży macierz przez k wektorów (Y = a * X, X i Y to n x k wierszami), bloki wierszy równolegle.
+ * Element a[i][l] jest czytany raz i mnożony przez cały wiersz l macierzy X.
+ * Arytmetyka zawija modulo 2^32.
+ * @param a Wiersze macierzy.
+ * @param x Macierz X.
+ * @param k Liczba wektorów.
+ * @param y Macierz Y.
+ * @param n Rozmiar macierzy.
+ */
+static void gemm_wektory(int* const* a, const int* x, int k, int* y, int n)
+{
+    rownolegle(n, (long long)n * n * k, [&](int blok, int poczatek, int koniec) {
+        vector<unsigned int> suma(k);
+        for (int i = poczatek; i < koniec; i++)
+        {
+            for (int c = 0; c < k; c++)
+            {
+                suma[c] = 0;
+            }
+            const int* w = a[i];
+            for (int l = 0; l < n; l++)
+            {
+                unsigned int ail = w[l];
+                const int* xl = x + (size_t)l * k;
+                for (int c = 0; c < k; c++)
+                {
+                    suma[c] += ail * (unsigned int)xl[c];
+                }
+            }
+            int* yi = y + (size_t)i * k;
+            for (int c = 0; c < k; c++)
+            {
+                yi[c] = (int)suma[c];
+            }
+        }
+    });
+}
+
+/**
+ * @brief Zastępuje elementy a wynikiem f(a[i][j], b[i][j]), bloki wierszy równolegle.
+ * Funkcja jest rozwijana w pętli wewnętrznej, więc proste operacje są wektoryzowane.
+ * @tparam F Typ funkcji dwuargumentowej int x int -> int.
+ * @param a Wiersze wyniku i lewego argumentu.
+ * @param b Wiersze prawego argumentu.
+ * @param n Rozmiar macierzy.
+ * @param f Funkcja.
+ */
+template <class F>
+static void po_elementach(int* const* a, int* const* b, int n, F f)
+{
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int i = poczatek; i < koniec; i++)
+        {
+            int* w = a[i];
+            const int* v = b[i];
+            for (int j = 0; j < n; j++)
+            {
+                w[j] = f(w[j], v[j]);
+            }
+        }
+    });
+}
+
+/**
+ * @brief Wywołuje f(i, blad) dla każdego wiersza i, bloki wierszy równolegle.
+ * Każdy blok zbiera własny znacznik przepełnienia, więc wątki nie zapisują wspólnej zmiennej.
+ * @param n Rozmiar macierzy.
+ * @param f Funkcja przetwarzająca wiersz i uzupełniająca znacznik blad.
+ * @return Suma logiczna znaczników wszystkich bloków.
+ */
+template <class F>
+static int wiersze_z_bledem(int n, F f)
+{
+    vector<int> bledy(liczba_blokow(n));
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        int blad = 0;
+        for (int i = poczatek; i < koniec; i++)
+        {
+            f(i, blad);
+        }
+        bledy[blok] = blad;
+    });
+    int blad = 0;
+    for (size_t b = 0; b < bledy.size(); b++)
+    {
+        blad |= bledy[b];
+    }
+    return blad;
+}
+
+/**
+ * @brief Sprawdza, czy dwa bufory mają wspólne elementy.
+ * @param a Pierwszy bufor.
+ * @param b Drugi bufor.
+ * @return true jeśli bufory się pokrywają.
+ */
+static bool pokrywaja_sie(span<const int> a, span<const int> b)
+{
+    return a.data() < b.data() + b.size() && b.data() < a.data() + a.size();
+}
+
+/**
+ * @brief Wyznacza skrajny element macierzy i jego pierwszą pozycję w kolejności wierszy.
+ * Każdy blok wierszy wyznacza skrajne wartości wierszy pętlą bez rozgałęzień,
+ * a kolumny szuka tylko w najlepszym wierszu. Wyniki bloków są łączone
+ * w kolejności bloków.
+ * @param mac Wiersze macierzy.
+ * @param n Rozmiar macierzy.
+ * @param maks true dla maksimum, false dla minimum.
+ * @param x Wiersz znalezionego elementu.
+ * @param y Kolumna znalezionego elementu.
+ * @return Skrajna wartość.
+ */
+static int ekstremum(int** mac, int n, bool maks, int& x, int& y)
+{
+    vector<int> wartosc(liczba_blokow(n));
+    vector<int> wiersz(liczba_blokow(n));
+    vector<int> kolumna(liczba_blokow(n));
+    rownolegle(n, (long long)n * n, [&](int b, int poczatek, int koniec) {
+        int najlepsza = 0;
+        int bx = -1;
+        for (int i = poczatek; i < koniec; i++)
+        {
+            const int* w = mac[i];
+            int v = w[0];
+            for (int j = 1; j < n; j++)
+            {
+                v = maks ? (w[j] > v ? w[j] : v) : (w[j] < v ? w[j] : v);
+            }
+            if (bx < 0 || (maks ? v > najlepsza : v < najlepsza))
+            {
+                najlepsza = v;
+                bx = i;
+            }
+        }
+        int by = 0;
+        while (mac[bx][by] != najlepsza)
+        {
+            by++;
+        }
+        wartosc[b] = najlepsza;
+        wiersz[b] = bx;
+        kolumna[b] = by;
+    });
+    int wynik = 0;
+    for (int b = 0; b < liczba_blokow(n); b++)
+    {
+        if (b == 0 || (maks ? wartosc[b] > wynik : wartosc[b] < wynik))
+        {
+            wynik = wartosc[b];
+            x = wiersz[b];
+            y = kolumna[b];
+        }
+    }
+    return wynik;
+}
+
+/**
+ * @brief Mnoży dwie liczby 64-bitowe, jeśli moduł iloczynu jest mniejszy od 2^62.
+ * Różnica dwóch takich iloczynów ma moduł mniejszy od 2^63, więc mieści się w long long.
+ * @param a Pierwszy czynnik.
+ * @param b Drugi czynnik.
+ * @param w Wynik: iloczyn.
+ * @return false jeśli iloczyn byłby za duży.
+ */
+static bool iloczyn_bareissa(long long a, long long b, long long& w)
+{
+    unsigned long long ua = a < 0 ? 0ULL - (unsigned long long)a : (unsigned long long)a;
+    unsigned long long ub = b < 0 ? 0ULL - (unsigned long long)b : (unsigned long long)b;
+    if (ua != 0 && ub > ((1ULL << 62) - 1) / ua)
+    {
+        return false;
+    }
+    w = a * b;
+    return true;
+}
+
+/**
+ * @brief Zwraca odwrotność a modulo p (z małego twierdzenia Fermata).
+ * @param a Liczba z przedziału [1, p).
+ * @param p Liczba pierwsza mniejsza od 2^31.
+ * @return a^(p - 2) mod p.
+ */
+static unsigned int odwrotnosc_modulo(unsigned long long a, unsigned int p)
+{
+    unsigned long long wynik = 1;
+    for (unsigned int k = p - 2; k > 0; k >>= 1)
+    {
+        if (k & 1)
+        {
+            wynik = wynik * a % p;
+        }
+        a = a * a % p;
+    }
+    return (unsigned int)wynik;
+}
+
+/**
+ * @brief Eliminacja Gaussa modulo p na kopii macierzy.
+ * Wiersz piwota jest normowany do jedynki, a wiersze pod nim są aktualizowane blokami równolegle;
+ * wywołana z zadania puli (jedna z wielu liczb pierwszych) działa szeregowo.
+ * @param mac Wiersze macierzy.
+ * @param n Rozmiar macierzy.
+ * @param p Liczba pierwsza mniejsza od 2^31.
+ * @param wyznacznik Wynik: wyznacznik modulo p.
+ * @return Rząd modulo p.
+ */
+static int eliminacja_modulo(int* const* mac, int n, unsigned int p, unsigned int& wyznacznik)
+{
+    MIERZ_OPERACJE(OP_ELIMINACJA, (long long)n * n * n / 3 * 2 * sizeof(unsigned int));
+    vector<unsigned int> a((size_t)n * n);
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < n; j++)
+        {
+            long long v = mac[i][j] % (long long)p;
+            a[(size_t)i * n + j] = (unsigned int)(v < 0 ? v + p : v);
+        }
+    }
+    unsigned long long wyz = 1;
+    int r = 0;
+    for (int c = 0; c < n && r < n; c++)
+    {
+        int k = r;
+        while (k < n && a[(size_t)k * n + c] == 0)
+        {
+            k++;
+        }
+        if (k == n)
+        {
+            wyz = 0;
+            continue;
+        }
+        unsigned int* w = &a[(size_t)r * n];
+        if (k != r)
+        {
+            unsigned int* v = &a[(size_t)k * n];
+            for (int j = c; j < n; j++)
+            {
+                unsigned int t = w[j];
+                w[j] = v[j];
+                v[j] = t;
+            }
+            wyz = (p - wyz) % p;
+        }
+        wyz = wyz * w[c] % p;
+        unsigned long long odwrotnosc = odwrotnosc_modulo(w[c], p);
+        for (int j = c + 1; j < n; j++)
+        {
+            w[j] = (unsigned int)(w[j] * odwrotnosc % p);
+        }
+        w[c] = 1;
+        int pod = n - r - 1;
+        rownolegle(pod, (long long)pod * (n - c), [&](int blok, int poczatek, int koniec) {
+            for (int i = r + 1 + poczatek; i < r + 1 + koniec; i++)
+            {
+                unsigned int* v = &a[(size_t)i * n];
+                if (v[c] == 0)
+                {
+                    continue;
+                }
+                unsigned long long f = p - v[c];
+                for (int j = c + 1; j < n; j++)
+                {
+                    v[j] = (unsigned int)((v[j] + f * w[j]) % p);
+                }
+                v[c] = 0;
+            }
+        });
+        r++;
+    }
+    wyznacznik = r < n ? 0 : (unsigned int)wyz;
+    return r;
+}
+
+/**
+ * @brief Zwraca log2 ograniczenia Hadamarda: iloczynu norm euklidesowych niezerowych wierszy.
+ * Ogranicza ono moduł wyznacznika i każdego minora macierzy.
+ * @param mac Wiersze macierzy.
+ * @param n Rozmiar macierzy.
+ * @return Logarytm o podstawie 2 ograniczenia.
+ */
+static double log2_hadamarda(int* const* mac, int n)
+{
+    double wynik = 0;
+    for (int i = 0; i < n; i++)
+    {
+        double kwadraty = 0;
+        for (int j = 0; j < n; j++)
+        {
+            kwadraty += (double)mac[i][j] * mac[i][j];
+        }
+        if (kwadraty > 0)
+        {
+            wynik += 0.5 * log2(kwadraty);
+        }
+    }
+    return wynik;
+}
+
+/**
+ * @brief Zwraca kolejne największe liczby pierwsze mniejsze od 2^31, aż ich iloczyn przekroczy 2^bity.
+ * Liczby są wyznaczane raz (dzieleniem próbnym) i zapamiętywane dla kolejnych wywołań.
+ * @param bity Wymagana liczba bitów iloczynu.
+ * @return Co najmniej jedna liczba pierwsza, malejąco.
+ */
+static vector<unsigned int> liczby_pierwsze(double bity)
+{
+    static mutex blokada;
+    static vector<unsigned int> pierwsze;
+    lock_guard<mutex> l(blokada);
+    vector<unsigned int> wynik;
+    double suma = 0;
+    for (size_t i = 0; wynik.empty() || suma <= bity; i++)
+    {
+        if (i == pierwsze.size())
+        {
+            unsigned int kandydat = pierwsze.empty() ? 2147483647u : pierwsze.back() - 2;
+            while (true)
+            {
+                bool pierwsza = true;
+                for (unsigned int d = 3; d * d <= kandydat; d += 2)
+                {
+                    if (kandydat % d == 0)
+                    {
+                        pierwsza = false;
+                        break;
+                    }
+                }
+                if (pierwsza)
+                {
+                    break;
+                }
+                kandydat -= 2;
+            }
+            pierwsze.push_back(kandydat);
+        }
+        wynik.push_back(pierwsze[i]);
+        suma += log2((double)pierwsze[i]);
+    }
+    return wynik;
+}
+
+/**
+ * @brief Mnoży liczbę zapisaną cyframi o podstawie 10^9 (od najmniej znaczącej) i dodaje składnik.
+ * @param a Liczba, zastępowana wynikiem a * mnoznik + skladnik.
+ * @param mnoznik Mnożnik mniejszy od 2^32.
+ * @param skladnik Składnik mniejszy od 2^32.
+ */
+static void mnoz_dodaj_dziesietnie(vector<unsigned int>& a, unsigned int mnoznik, unsigned int skladnik)
+{
+    unsigned long long przeniesienie = skladnik;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        unsigned long long t = (unsigned long long)a[i] * mnoznik + przeniesienie;
+        a[i] = (unsigned int)(t % 1000000000);
+        przeniesienie = t / 1000000000;
+    }
+    while (przeniesienie > 0)
+    {
+        a.push_back((unsigned int)(przeniesienie % 1000000000));
+        przeniesienie /= 1000000000;
+    }
+    while (a.size() > 1 && a.back() == 0)
+    {
+        a.pop_back();
+    }
+}
+
+/**
+ * @brief Odtwarza liczbę całkowitą z reszt modulo różne liczby pierwsze i zapisuje ją dziesiętnie.
+ * Cyfry w systemie o podstawach p_0, p_1, ... są wyznaczane algorytmem Garnera, a wynikiem
+ * jest reprezentant z przedziału (-M/2, M/2], gdzie M to iloczyn liczb pierwszych.
+ * @param reszty Reszty modulo kolejne liczby pierwsze.
+ * @param pierwsze Liczby pierwsze.
+ * @return Zapis dziesiętny liczby.
+ */
+static string z_reszt(const vector<unsigned int>& reszty, const vector<unsigned int>& pierwsze)
+{
+    size_t k = pierwsze.size();
+    vector<unsigned int> cyfry(k);
+    for (size_t i = 0; i < k; i++)
+    {
+        unsigned long long p = pierwsze[i];
+        unsigned long long x = 0;
+        unsigned long long iloczyn = 1;
+        for (size_t j = 0; j < i; j++)
+        {
+            x = (x + cyfry[j] * iloczyn) % p;
+            iloczyn = iloczyn * pierwsze[j] % p;
+        }
+        cyfry[i] = (unsigned int)((reszty[i] + p - x) % p * odwrotnosc_modulo(iloczyn, (unsigned int)p) % p);
+    }
+    vector<unsigned int> liczba = { 0 };
+    vector<unsigned int> modul = { 1 };
+    for (size_t i = k; i-- > 0;)
+    {
+        mnoz_dodaj_dziesietnie(liczba, pierwsze[i], cyfry[i]);
+        mnoz_dodaj_dziesietnie(modul, pierwsze[i], 0);
+    }
+    vector<unsigned int> podwojona = liczba;
+    mnoz_dodaj_dziesietnie(podwojona, 2, 0);
+    bool ujemna = podwojona.size() != modul.size() ? podwojona.size() > modul.size()
+        : lexicographical_compare(modul.rbegin(), modul.rend(), podwojona.rbegin(), podwojona.rend());
+    if (ujemna)
+    {
+        long long pozyczka = 0;
+        for (size_t i = 0; i < modul.size(); i++)
+        {
+            long long t = (long long)modul[i] - (i < liczba.size() ? liczba[i] : 0) - pozyczka;
+            pozyczka = t < 0 ? 1 : 0;
+            modul[i] = (unsigned int)(t < 0 ? t + 1000000000 : t);
+        }
+        while (modul.size() > 1 && modul.back() == 0)
+        {
+            modul.pop_back();
+        }
+        liczba = modul;
+    }
+    string wynik = ujemna ? "-" : "";
+    wynik += to_string(liczba.back());
+    for (size_t i = liczba.size() - 1; i-- > 0;)
+    {
+        string cyfra = to_string(liczba[i]);
+        wynik += string(9 - cyfra.size(), '0') + cyfra;
+    }
+    return wynik;
+}
+
 /**
  * @brief Konstruktor domyślny klasy matrix.
  */
-matrix::matrix(void)
+matrix::matrix(void)
+{
+    mac = nullptr;
+    dlug = nullptr;
+}
+
+/**
+ * @brief Konstruktor klasy matrix, który alokuje macierz o rozmiarze n x n.
+ * @param n Rozmiar macierzy.
+ */
+matrix::matrix(int n)
+{
+    alokuj(n);
+    *dlug = n;
+}
+
+/**
+ * @brief Konstruktor klasy matrix, który alokuje macierz o rozmiarze n x n i wypełnia ją wartościami z tablicy t.
+ * @param n Rozmiar macierzy.
+ * @param t Tablica wartości do wypełnienia macierzy.
+ */
+matrix::matrix(int n, int* t)
+{
+    alokuj(n);
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int i = poczatek; i < koniec; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                mac[i][j] = t[(i * n) + j];
+            }
+        }
+    });
+    *dlug = n;
+}
+
+/**
+ * @brief Konstruktor kopiujący klasy matrix.
+ * Kopia współdzieli bufor z m, dopóki jedna z nich nie zostanie zmodyfikowana.
+ * @param m Obiekt matrix, który ma zostać skopiowany.
+ */
+matrix::matrix(const matrix& m)
+{
+    mac = m.mac;
+    dlug = m.dlug;
+    licznik = m.licznik;
+    poj = m.poj;
+    if (licznik != nullptr)
+    {
+        licznik->fetch_add(1, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Operator przypisania; podobnie jak kopia współdzieli bufor do pierwszego zapisu.
+ * @param m Obiekt matrix, który ma zostać przypisany.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::operator=(const matrix& m)
+{
+    if (licznik == m.licznik)
+    {
+        return *this;
+    }
+    if (m.licznik != nullptr)
+    {
+        m.licznik->fetch_add(1, memory_order_relaxed);
+    }
+    zwolnij();
+    mac = m.mac;
+    dlug = m.dlug;
+    licznik = m.licznik;
+    poj = m.poj;
+    return *this;
+}
+
+/**
+ * @brief Destruktor klasy matrix.
+ */
+matrix::~matrix(void)
+{
+    zwolnij();
+}
+
+/**
+ * @brief Bit licznika właścicieli oznaczający bufor tylko do odczytu.
+ * Licznik z tym bitem jest zawsze większy od 1, więc odlacz i alokuj traktują bufor jak współdzielony.
+ */
+static const int BUFOR_TYLKO_DO_ODCZYTU = 1 << 30;
+
+/**
+ * @brief Zwalnia udział w buforze; bufor jest usuwany przez ostatniego właściciela.
+ */
+void matrix::zwolnij(void)
+{
+    if (licznik != nullptr && (licznik->fetch_sub(1, memory_order_acq_rel) & ~BUFOR_TYLKO_DO_ODCZYTU) == 1)
+    {
+        zwolnij_wiersze(mac);
+        delete dlug;
+        delete licznik;
+    }
+    mac = nullptr;
+    dlug = nullptr;
+    licznik = nullptr;
+    poj = 0;
+}
+
+/**
+ * @brief Tworzy prywatną kopię współdzielonego bufora.
+ */
+void matrix::sklonuj(void)
+{
+    int n = *dlug;
+    int** kopia = nowe_wiersze(n);
+    memcpy(kopia[0], mac[0], (size_t)n * n * sizeof(int));
+    przejmij(kopia, n);
+}
+
+/**
+ * @brief Przejmuje na własność wiersze o rozmiarze n, zwalniając dotychczasowy bufor.
+ * @param wiersze Tablica wskaźników na wiersze zaalokowane przez new.
+ * @param n Rozmiar macierzy.
+ */
+void matrix::przejmij(int** wiersze, int n)
+{
+    zwolnij();
+    mac = wiersze;
+    dlug = new int(n);
+    licznik = new atomic<int>(1);
+    poj = n;
+}
+
+/**
+ * @brief Ustawia macierz na bufor tylko do odczytu (np. segment pamięci współdzielonej) bez kopiowania.
+ * Bufor jest zwalniany przez zwolnij_bufor po odejściu ostatniego właściciela; każdy zapis najpierw go kopiuje.
+ * @param dane Bufor n x n udostępniony przez bufor_wspolny.
+ * @param n Rozmiar macierzy.
+ */
+void matrix::przejmij_do_odczytu(int* dane, int n)
+{
+    int** w = new int* [n > 0 ? n : 1];
+    w[0] = dane;
+    for (int i = 1; i < n; i++)
+    {
+        w[i] = dane + (size_t)i * n;
+    }
+    przejmij(w, n);
+    licznik->fetch_or(BUFOR_TYLKO_DO_ODCZYTU, memory_order_relaxed);
+}
+
+/**
+ * @brief Sprawdza, czy macierz współdzieli bufor z inną kopią.
+ * @return true jeśli bufor jest współdzielony.
+ */
+bool matrix::wspoldzielona(void) const
+{
+    return licznik != nullptr && licznik->load(memory_order_acquire) > 1;
+}
+
+/**
+ * @brief Wymienia zawartość (bufor, rozmiar i pojemność) z macierzą m bez kopiowania danych.
+ * @param m Macierz do wymiany.
+ */
+void matrix::zamien(matrix& m)
+{
+    swap(dlug, m.dlug);
+    swap(mac, m.mac);
+    swap(przepelniona, m.przepelniona);
+    swap(licznik, m.licznik);
+    swap(poj, m.poj);
+}
+
+/**
+ * @brief Alokuje pamięć dla macierzy o rozmiarze n x n.
+ * Jeśli bufor nie jest współdzielony i n nie przekracza pojemności, jest używany ponownie
+ * bez alokacji; zawartość jest wtedy nieokreślona.
+ * @param n Rozmiar macierzy.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::alokuj(int n)
+{
+    MIERZ_OPERACJE(OP_ALOKUJ, (long long)n * n * sizeof(int));
+    if (mac == nullptr || wspoldzielona() || n > poj)
+    {
+        przejmij(nowe_wiersze(n), n);
+        return *this;
+    }
+    for (int i = 1; i < n; i++)
+    {
+        mac[i] = mac[0] + (size_t)i * n;
+    }
+    *dlug = n;
+    return *this;
+}
+
+/**
+ * @brief Zmienia rozmiar macierzy na n x n, opcjonalnie zachowując zawartość.
+ * Przy zachowaniu zawartości wspólny lewy górny fragment pozostaje bez zmian, a nowe
+ * elementy są zerowane. W obrębie pojemności wiersze są przesuwane w miejscu.
+ * @param n Nowy rozmiar macierzy.
+ * @param zachowaj true aby zachować zawartość.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::alokuj(int n, bool zachowaj)
+{
+    if (!zachowaj || mac == nullptr)
+    {
+        return alokuj(n);
+    }
+    MIERZ_OPERACJE(OP_ALOKUJ, (long long)n * n * sizeof(int));
+    int stary = *dlug;
+    int wspolny = stary < n ? stary : n;
+    if (wspoldzielona() || n > poj)
+    {
+        int** nowe = nowe_wiersze(n);
+        for (int i = 0; i < n; i++)
+        {
+            if (i < wspolny)
+            {
+                memcpy(nowe[i], mac[i], wspolny * sizeof(int));
+            }
+            for (int j = (i < wspolny ? wspolny : 0); j < n; j++)
+            {
+                nowe[i][j] = 0;
+            }
+        }
+        przejmij(nowe, n);
+        return *this;
+    }
+    int* dane = mac[0];
+    if (n < stary)
+    {
+        for (int i = 1; i < n; i++)
+        {
+            memmove(dane + (size_t)i * n, dane + (size_t)i * stary, n * sizeof(int));
+        }
+    }
+    else if (n > stary)
+    {
+        for (int i = stary - 1; i >= 0; i--)
+        {
+            memmove(dane + (size_t)i * n, dane + (size_t)i * stary, stary * sizeof(int));
+            memset(dane + (size_t)i * n + stary, 0, (n - stary) * sizeof(int));
+        }
+        memset(dane + (size_t)stary * n, 0, (size_t)(n - stary) * n * sizeof(int));
+    }
+    for (int i = 1; i < n; i++)
+    {
+        mac[i] = dane + (size_t)i * n;
+    }
+    *dlug = n;
+    return *this;
+}
+
+/**
+ * @brief Zwraca pojemność bufora.
+ * @return Największy rozmiar n, dla którego alokuj nie alokuje pamięci.
+ */
+int matrix::pojemnosc(void) const
+{
+    return poj;
+}
+
+/**
+ * @brief Zwraca sposób, w jaki przydzielono bufor macierzy (sterta, mapowanie, duże strony).
+ * @return Sposób przydziału; PRZYDZIAL_STERTA dla macierzy bez bufora.
+ */
+sposob_przydzialu matrix::przydzial(void) const
+{
+    return mac == nullptr ? PRZYDZIAL_STERTA : sposob_bufora(mac[0]);
+}
+
+/**
+ * @brief Zwalnia nadmiarową pojemność, przenosząc zawartość do bufora o rozmiarze dokładnie n x n.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::dopasuj_pojemnosc(void)
+{
+    if (mac == nullptr || poj == *dlug)
+    {
+        return *this;
+    }
+    int n = *dlug;
+    int** nowe = nowe_wiersze(n);
+    memcpy(nowe[0], mac[0], (size_t)n * n * sizeof(int));
+    przejmij(nowe, n);
+    return *this;
+}
+
+/**
+ * @brief Odwraca macierz (transpozycja).
+ * Elementy są zamieniane parami kafelków (I, J) i (J, I) o boku z konfiguracji jąder, więc oba
+ * kafelki mieszczą się w pamięci podręcznej; wiersze kafelków są rozdzielane między wątki.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::dowroc(void)
+{
+    MIERZ_OPERACJE(OP_DOWROC, bajty_macierzy(dlug, 2));
+    odlacz();
+    int n = *dlug;
+    konfiguracja_jader k = konfiguracja(n);
+    int bok = k.kafelek_transpozycji;
+    int kafelki = (n + bok - 1) / bok;
+    rownolegle_zadania(kafelki, (long long)n * n, [&](int ki) {
+        int i0 = ki * bok;
+        int i1 = i0 + bok < n ? i0 + bok : n;
+        for (int j0 = i0; j0 < n; j0 += bok)
+        {
+            int j1 = j0 + bok < n ? j0 + bok : n;
+            for (int i = i0; i < i1; i++)
+            {
+                int* w = mac[i];
+                for (int j = j0 > i + 1 ? j0 : i + 1; j < j1; j++)
+                {
+                    swap(w[j], mac[j][i]);
+                }
+            }
+        }
+    }, k.watki);
+    return *this;
+}
+
+/**
+ * @brief Wypełnia macierz losowymi wartościami.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::losuj(void)
+{
+    MIERZ_OPERACJE(OP_LOSUJ, bajty_macierzy(dlug, 1));
+    odlacz();
+    srand(time(nullptr));
+
+    for (int i = 0; i < *dlug; i++)
+    {
+        for (int j = 0; j < *dlug; j++)
+        {
+            mac[i][j] = rand() % 10;
+        }
+    }
+    return *this;
+}
+
+/**
+ * @brief Wypełnia macierz losowymi wartościami w określonej liczbie komórek.
+ * @param x Liczba komórek do wypełnienia.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::losuj(int x)
+{
+    MIERZ_OPERACJE(OP_LOSUJ, (long long)x * sizeof(int));
+    odlacz();
+    srand(time(nullptr));
+    int t1;
+    int t2;
+    for (int i = 0; i < x; i++) {
+        t1 = rand() % *dlug;
+        t2 = rand() % *dlug;
+        mac[t1][t2] = rand() % 10;
+    }
+    return *this;
+}
+
+/**
+ * @brief Ustawia wartości na przekątnej macierzy.
+ * @param t Tablica wartości do ustawienia na przekątnej.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::diagonalna(int* t)
+{
+    odlacz();
+    int n = *dlug;
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int i = poczatek; i < koniec; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                mac[i][j] = 0;
+            }
+            mac[i][i] = t[i];
+        }
+    });
+    return *this;
+}
+
+/**
+ * @brief Ustawia wartości na przekątnej macierzy z przesunięciem.
+ * @param k Przesunięcie przekątnej.
+ * @param t Tablica wartości do ustawienia na przekątnej.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::diagonalna_k(int k, int* t)
+{
+    odlacz();
+    int n = *dlug;
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        memset(mac[poczatek], 0, (size_t)(koniec - poczatek) * n * sizeof(int));
+    });
+    if (k != 0) {
+        if (k > 0)
+        {
+            for (int i = 0; i < *dlug - k; i++)
+            {
+                mac[i][i + k] = t[i + k];
+            }
+        }
+        else {
+            for (int i = -k; i < *dlug; i++)
+            {
+                mac[i][i + k] = t[i + k];
+            }
+        }
+
+    }
+    else {
+        diagonalna(t);
+    }
+    return *this;
+}
+
+/**
+ * @brief Ustawia wartości w kolumnie macierzy.
+ * @param x Numer kolumny.
+ * @param t Tablica wartości do ustawienia w kolumnie.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::kolumna(int x, int* t)
+{
+    odlacz();
+    for (int i = 0; i < *dlug; i++)
+    {
+        mac[i][x] = t[i];
+    }
+    return *this;
+}
+
+/**
+ * @brief Ustawia wartości w wierszu macierzy.
+ * @param y Numer wiersza.
+ * @param t Tablica wartości do ustawienia w wierszu.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::wiersz(int y, int* t)
+{
+    odlacz();
+    memcpy(mac[y], t, *dlug * sizeof(int));
+    return *this;
+}
+
+/**
+ * @brief Ustawia wartości w wierszu macierzy z bufora o znanej długości.
+ * @param y Numer wiersza.
+ * @param t Bufor n wartości.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::wiersz(int y, span<const int> t)
+{
+    if (t.size() < (size_t)*dlug)
+    {
+        cout << "Bufor jest za krotki" << endl;
+        return *this;
+    }
+    odlacz();
+    memcpy(mac[y], t.data(), *dlug * sizeof(int));
+    return *this;
+}
+
+/**
+ * @brief Ustawia wartości w kolumnie macierzy z bufora o znanej długości.
+ * @param x Numer kolumny.
+ * @param t Bufor n wartości.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::kolumna(int x, span<const int> t)
+{
+    if (t.size() < (size_t)*dlug)
+    {
+        cout << "Bufor jest za krotki" << endl;
+        return *this;
+    }
+    odlacz();
+    const int* d = t.data();
+    for (int i = 0; i < *dlug; i++)
+    {
+        mac[i][x] = d[i];
+    }
+    return *this;
+}
+
+/**
+ * @brief Ustawia prostokątny blok macierzy z bufora zapisanego wierszami.
+ * @param x Pierwszy wiersz bloku.
+ * @param y Pierwsza kolumna bloku.
+ * @param wys Liczba wierszy bloku.
+ * @param szer Liczba kolumn bloku.
+ * @param t Bufor wys * szer wartości.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::blok(int x, int y, int wys, int szer, span<const int> t)
+{
+    if (x < 0 || y < 0 || wys < 0 || szer < 0 || x + wys > *dlug || y + szer > *dlug)
+    {
+        cout << "Blok wykracza poza macierz" << endl;
+        return *this;
+    }
+    if (t.size() < (size_t)wys * szer)
+    {
+        cout << "Bufor jest za krotki" << endl;
+        return *this;
+    }
+    odlacz();
+    for (int i = 0; i < wys; i++)
+    {
+        memcpy(mac[x + i] + y, t.data() + (size_t)i * szer, szer * sizeof(int));
+    }
+    return *this;
+}
+
+/**
+ * @brief Kopiuje wiersz macierzy do bufora.
+ * @param y Numer wiersza.
+ * @param t Bufor na n wartości.
+ */
+void matrix::pobierz_wiersz(int y, span<int> t) const
+{
+    if (t.size() < (size_t)*dlug)
+    {
+        cout << "Bufor jest za krotki" << endl;
+        return;
+    }
+    memcpy(t.data(), mac[y], *dlug * sizeof(int));
+}
+
+/**
+ * @brief Kopiuje kolumnę macierzy do bufora.
+ * @param x Numer kolumny.
+ * @param t Bufor na n wartości.
+ */
+void matrix::pobierz_kolumne(int x, span<int> t) const
+{
+    if (t.size() < (size_t)*dlug)
+    {
+        cout << "Bufor jest za krotki" << endl;
+        return;
+    }
+    int* d = t.data();
+    for (int i = 0; i < *dlug; i++)
+    {
+        d[i] = mac[i][x];
+    }
+}
+
+/**
+ * @brief Kopiuje prostokątny blok macierzy do bufora (wierszami).
+ * @param x Pierwszy wiersz bloku.
+ * @param y Pierwsza kolumna bloku.
+ * @param wys Liczba wierszy bloku.
+ * @param szer Liczba kolumn bloku.
+ * @param t Bufor na wys * szer wartości.
+ */
+void matrix::pobierz_blok(int x, int y, int wys, int szer, span<int> t) const
+{
+    if (x < 0 || y < 0 || wys < 0 || szer < 0 || x + wys > *dlug || y + szer > *dlug)
+    {
+        cout << "Blok wykracza poza macierz" << endl;
+        return;
+    }
+    if (t.size() < (size_t)wys * szer)
+    {
+        cout << "Bufor jest za krotki" << endl;
+        return;
+    }
+    for (int i = 0; i < wys; i++)
+    {
+        memcpy(t.data() + (size_t)i * szer, mac[x + i] + y, szer * sizeof(int));
+    }
+}
+
+/**
+ * @brief Ustawia wartości na przekątnej macierzy na 1, a pozostałe na 0.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::przekatna(void)
+{
+    odlacz();
+    int n = *dlug;
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int i = poczatek; i < koniec; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                if (i != j)
+                {
+                    mac[i][j] = 0;
+                }
+                else {
+                    mac[i][j] = 1;
+                }
+            }
+        }
+    });
+    return *this;
+}
+
+/**
+ * @brief Ustawia wartości pod przekątną macierzy na 1, a pozostałe na 0.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::pod_przekatna(void)
+{
+    odlacz();
+    int n = *dlug;
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int i = poczatek; i < koniec; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                if (i > j)
+                {
+                    mac[i][j] = 1;
+                }
+                else {
+                    mac[i][j] = 0;
+                }
+            }
+        }
+    });
+    return *this;
+}
+
+/**
+ * @brief Ustawia wartości nad przekątną macierzy na 1, a pozostałe na 0.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::nad_przekatna(void)
+{
+    odlacz();
+    int n = *dlug;
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int i = poczatek; i < koniec; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                if (i < j)
+                {
+                    mac[i][j] = 1;
+                }
+                else {
+                    mac[i][j] = 0;
+                }
+            }
+        }
+    });
+    return *this;
+}
+
+/**
+ * @brief Ustawia wartości w macierzy w formie szachownicy.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::szachownica(void)
 {
-    mac = nullptr;
-    dlug = nullptr;
+    odlacz();
+    int n = *dlug;
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int i = poczatek; i < koniec; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                if ((i + j) % 2 != 0)
+                {
+                    mac[i][j] = 1;
+                }
+                else {
+                    mac[i][j] = 0;
+                }
+            }
+        }
+    });
+    return *this;
 }
 
 /**
- * @brief Konstruktor klasy matrix, który alokuje macierz o rozmiarze n x n.
- * @param n Rozmiar macierzy.
+ * @brief Operator dodawania macierzy.
+ * @param m Macierz do dodania.
+ * @return Referencja do obiektu matrix.
  */
-matrix::matrix(int n)
+matrix& matrix::operator+(matrix& m)
 {
-    alokuj(n);
-    *dlug = n;
+    return dodaj<zawijanie>(m);
 }
 
 /**
- * @brief Konstruktor klasy matrix, który alokuje macierz o rozmiarze n x n i wypełnia ją wartościami z tablicy t.
- * @param n Rozmiar macierzy.
- * @param t Tablica wartości do wypełnienia macierzy.
+ * @brief Operator mnożenia macierzy.
+ * @param m Macierz do pomnożenia.
+ * @return Referencja do obiektu matrix.
  */
-matrix::matrix(int n, int* t)
+matrix& matrix::operator*(matrix& m)
+{
+    return mnoz<zawijanie>(m);
+}
+
+/**
+ * @brief Operator odejmowania macierzy (element po elemencie, z zawijaniem modulo 2^32).
+ * @param m Macierz do odjęcia.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::operator-(matrix& m)
+{
+    if (*dlug != *m.dlug)
+    {
+        cout << "Macierze posiadaja rozne dlugosci" << endl;
+        return *this;
+    }
+    MIERZ_OPERACJE(OP_ELEMENTOWE, bajty_macierzy(dlug, 3));
+    odlacz();
+    po_elementach(mac, m.mac, *dlug, [](int x, int y) { return (int)((unsigned int)x - (unsigned int)y); });
+    return *this;
+}
+
+/**
+ * @brief Mnoży macierz element po elemencie przez m (iloczyn Hadamarda, z zawijaniem modulo 2^32).
+ * @param m Macierz do pomnożenia.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::hadamard(matrix& m)
+{
+    if (*dlug != *m.dlug)
+    {
+        cout << "Macierze posiadaja rozne dlugosci" << endl;
+        return *this;
+    }
+    MIERZ_OPERACJE(OP_ELEMENTOWE, bajty_macierzy(dlug, 3));
+    odlacz();
+    po_elementach(mac, m.mac, *dlug, [](int x, int y) { return (int)((unsigned int)x * (unsigned int)y); });
+    return *this;
+}
+
+/**
+ * @brief Zastępuje każdy element mniejszym z pary (this[i][j], m[i][j]).
+ * @param m Macierz do porównania.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::minimum_elementow(matrix& m)
+{
+    if (*dlug != *m.dlug)
+    {
+        cout << "Macierze posiadaja rozne dlugosci" << endl;
+        return *this;
+    }
+    MIERZ_OPERACJE(OP_ELEMENTOWE, bajty_macierzy(dlug, 3));
+    odlacz();
+    po_elementach(mac, m.mac, *dlug, [](int x, int y) { return x < y ? x : y; });
+    return *this;
+}
+
+/**
+ * @brief Zastępuje każdy element większym z pary (this[i][j], m[i][j]).
+ * @param m Macierz do porównania.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::maksimum_elementow(matrix& m)
+{
+    if (*dlug != *m.dlug)
+    {
+        cout << "Macierze posiadaja rozne dlugosci" << endl;
+        return *this;
+    }
+    MIERZ_OPERACJE(OP_ELEMENTOWE, bajty_macierzy(dlug, 3));
+    odlacz();
+    po_elementach(mac, m.mac, *dlug, [](int x, int y) { return x > y ? x : y; });
+    return *this;
+}
+
+/**
+ * @brief Zapisuje w macierzy iloczyn Kroneckera a (x) b o rozmiarze (na * nb) x (na * nb).
+ * Czynniki są najpierw kopiowane (bez kopiowania danych, dzięki współdzieleniu bufora),
+ * więc wynik może być zapisany do a lub b. Wiersz r = i * nb + k wyniku to kolejne
+ * odcinki a[i][j] * b[k]; bloki wierszy wyniku są liczone równolegle.
+ * Arytmetyka zawija modulo 2^32.
+ * @param a Lewy czynnik.
+ * @param b Prawy czynnik.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::iloczyn_kroneckera(matrix& a, matrix& b)
 {
+    matrix ka(a);
+    matrix kb(b);
+    int na = *ka.dlug;
+    int nb = *kb.dlug;
+    int n = na * nb;
+    MIERZ_OPERACJE(OP_ZEWNETRZNE, (long long)n * n * sizeof(int));
     alokuj(n);
-    int k = 0;
+    int** c = mac;
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int r = poczatek; r < koniec; r++)
+        {
+            const int* ai = ka.mac[r / nb];
+            const int* bk = kb.mac[r % nb];
+            int* w = c[r];
+            for (int j = 0; j < na; j++)
+            {
+                unsigned int aij = ai[j];
+                int* odcinek = w + (size_t)j * nb;
+                for (int l = 0; l < nb; l++)
+                {
+                    odcinek[l] = (int)(aij * (unsigned int)bk[l]);
+                }
+            }
+        }
+    });
+    return *this;
+}
+
+/**
+ * @brief Zapisuje w macierzy iloczyn zewnętrzny x * y^T (z zawijaniem modulo 2^32).
+ * @param x Wektor n wartości (kolumna).
+ * @param y Wektor n wartości (wiersz).
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::iloczyn_zewnetrzny(span<const int> x, span<const int> y)
+{
+    int n = *dlug;
+    if (x.size() < (size_t)n || y.size() < (size_t)n)
+    {
+        cout << "Bufor jest za krotki" << endl;
+        return *this;
+    }
+    MIERZ_OPERACJE(OP_ZEWNETRZNE, bajty_macierzy(dlug, 1));
+    odlacz();
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int i = poczatek; i < koniec; i++)
+        {
+            unsigned int xi = x[i];
+            int* w = mac[i];
+            for (int j = 0; j < n; j++)
+            {
+                w[j] = (int)(xi * (unsigned int)y[j]);
+            }
+        }
+    });
+    return *this;
+}
+
+/**
+ * @brief Podnosi macierz do potęgi k metodą szybkiego potęgowania (przez podnoszenie do kwadratu).
+ * @param k Wykładnik (k >= 0).
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::potega(int k)
+{
+    return potega(k, 0);
+}
+
+/**
+ * @brief Podnosi macierz do potęgi k modulo modul metodą szybkiego potęgowania.
+ * Trzy bufory macierzy oraz bufory robocze jąder są alokowane raz na początku i wymieniane
+ * lub ponownie używane między krokami, więc wykonanie zajmuje O(log k) mnożeń bez alokacji w pętli.
+ * @param k Wykładnik (k >= 0).
+ * @param modul Moduł arytmetyki chroniący przed przepełnieniem int (0 - bez redukcji modulo).
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::potega(int k, int modul)
+{
+    MIERZ_OPERACJE(OP_POTEGA, bajty_macierzy(dlug, 3));
+    if (k < 0 || modul < 0)
+    {
+        cout << "Wykladnik i modul musza byc nieujemne" << endl;
+        return *this;
+    }
+    int n = *dlug;
+    int** wynik = nowe_wiersze(n);
+    int** baza = nowe_wiersze(n);
+    int** bufor = nowe_wiersze(n);
+    bufory_mnozenia bufory;
     for (int i = 0; i < n; i++)
     {
         for (int j = 0; j < n; j++)
         {
-            mac[i][j] = t[(i * n) + j];
+            wynik[i][j] = (i == j) ? 1 : 0;
+            baza[i][j] = mac[i][j];
+            if (modul != 0)
+            {
+                wynik[i][j] %= modul;
+                baza[i][j] %= modul;
+                if (baza[i][j] < 0)
+                {
+                    baza[i][j] += modul;
+                }
+            }
         }
     }
-    *dlug = n;
+
+    while (k > 0)
+    {
+        if (k & 1)
+        {
+            mnoz_wiersze(wynik, baza, bufor, n, modul, bufory);
+            swap(wynik, bufor);
+        }
+        k >>= 1;
+        if (k > 0)
+        {
+            mnoz_wiersze(baza, baza, bufor, n, modul, bufory);
+            swap(baza, bufor);
+        }
+    }
+
+    przejmij(wynik, n);
+    zwolnij_wiersze(baza);
+    zwolnij_wiersze(bufor);
+    return *this;
 }
 
 /**
- * @brief Konstruktor kopiujący klasy matrix.
- * @param m Obiekt matrix, który ma zostać skopiowany.
+ * @brief Mnożenie z epilogiem w jednym przebiegu: this = alfa * a * b + beta * this + przesuniecie.
+ * Zastępuje sekwencję a * b, *= alfa, += przesuniecie bez tymczasowych macierzy.
+ * Liczy równolegle jądrem mnożenia, a epilog stosuje przy zapisie wyniku; gdy b jest
+ * tą samą macierzą, wynik trafia do nowych wierszy zamiast do kopii b.
+ * @param a Lewy czynnik iloczynu.
+ * @param b Prawy czynnik iloczynu.
+ * @param alfa Mnożnik iloczynu a * b.
+ * @param beta Mnożnik dotychczasowej zawartości macierzy.
+ * @param przesuniecie Liczba dodawana do każdego elementu wyniku.
+ * @return Referencja do obiektu matrix.
+ */
+matrix& matrix::gemm(matrix& a, matrix& b, int alfa, int beta, int przesuniecie)
+{
+    MIERZ_OPERACJE(OP_GEMM, bajty_macierzy(dlug, 4));
+    if (*dlug != *a.dlug || *dlug != *b.dlug)
+    {
+        cout << "Macierze posiadaja rozne dlugosci" << endl;
+        return *this;
+    }
+    odlacz();
+    int n = *dlug;
+    bufory_mnozenia bufory;
+    epilog_gemm e = { (unsigned int)alfa, (unsigned int)beta, (unsigned int)przesuniecie, mac };
+    if (b.mac != mac)
+    {
+        mnoz_wiersze_zawijanie(a.mac, b.mac, mac, n, bufory, e);
+        return *this;
+    }
+
+    int** wynik = nowe_wiersze(n);
+    mnoz_wiersze_zawijanie(a.mac, b.mac, wynik, n, bufory, e);
+    przejmij(wynik, n);
+    return *this;
+}
+
+/**
+ * @brief Mnoży macierz przez wektor: y = this * x.
+ * Arytmetyka zawija modulo 2^32.
+ * @param x Wektor n wartości.
+ * @param y Bufor na n wartości wyniku (nie może pokrywać się z x).
+ */
+void matrix::mnoz_wektor(span<const int> x, span<int> y) const
+{
+    int n = dlug == nullptr ? 0 : *dlug;
+    if (x.size() < (size_t)n || y.size() < (size_t)n)
+    {
+        cout << "Bufor jest za krotki" << endl;
+        return;
+    }
+    if (pokrywaja_sie(x, y))
+    {
+        cout << "Wektory nie moga sie pokrywac" << endl;
+        return;
+    }
+    MIERZ_OPERACJE(OP_GEMV, (long long)n * (n + 2) * sizeof(int));
+    gemv_wiersze(mac, x.data(), y.data(), n);
+}
+
+/**
+ * @brief Mnoży wektor wierszowy przez macierz: y^T = x^T * this.
+ * Arytmetyka zawija modulo 2^32.
+ * @param x Wektor n wartości.
+ * @param y Bufor na n wartości wyniku (nie może pokrywać się z x).
+ */
+void matrix::mnoz_wektor_z_lewej(span<const int> x, span<int> y) const
+{
+    int n = dlug == nullptr ? 0 : *dlug;
+    if (x.size() < (size_t)n || y.size() < (size_t)n)
+    {
+        cout << "Bufor jest za krotki" << endl;
+        return;
+    }
+    if (pokrywaja_sie(x, y))
+    {
+        cout << "Wektory nie moga sie pokrywac" << endl;
+        return;
+    }
+    MIERZ_OPERACJE(OP_GEMV, (long long)n * (n + 2) * sizeof(int));
+    gemv_kolumny(mac, x.data(), y.data(), n);
+}
+
+/**
+ * @brief Mnoży macierz przez k wektorów naraz: Y = this * X, gdzie X i Y mają n x k elementów.
+ * Dla k = 1 używa jądra mnoz_wektor.
+ * @param x Macierz X (n x k, wierszami).
+ * @param k Liczba wektorów.
+ * @param y Bufor na macierz Y (n x k, wierszami; nie może pokrywać się z x).
+ */
+void matrix::mnoz_wektory(span<const int> x, int k, span<int> y) const
+{
+    int n = dlug == nullptr ? 0 : *dlug;
+    if (k < 1)
+    {
+        cout << "Liczba wektorow musi byc dodatnia" << endl;
+        return;
+    }
+    if (x.size() < (size_t)n * k || y.size() < (size_t)n * k)
+    {
+        cout << "Bufor jest za krotki" << endl;
+        return;
+    }
+    if (pokrywaja_sie(x, y))
+    {
+        cout << "Wektory nie moga sie pokrywac" << endl;
+        return;
+    }
+    MIERZ_OPERACJE(OP_GEMV, (long long)n * (n + 2 * k) * sizeof(int));
+    if (k == 1)
+    {
+        gemv_wiersze(mac, x.data(), y.data(), n);
+        return;
+    }
+    gemm_wektory(mac, x.data(), k, y.data(), n);
+}
+
+/**
+ * @brief Dodaje macierz m z wybraną polityką arytmetyki.
+ * Znacznik przepełnienia jest zbierany bez rozgałęzień w trakcie tej samej pętli,
+ * więc nie jest potrzebny osobny przebieg walidujący.
+ * @tparam P Polityka arytmetyki (zawijanie, nasycanie lub sprawdzanie).
+ * @param m Macierz do dodania.
+ * @return Referencja do obiektu matrix.
  */
-matrix::matrix(matrix& m)
+template <class P>
+matrix& matrix::dodaj(matrix& m)
 {
-    alokuj(*m.dlug);
-    for (int i = 0; i < *m.dlug; i++) {
-        for (int j = 0; j < *m.dlug; j++) {
-            mac[i][j] = m.mac[i][j];
+    MIERZ_OPERACJE(OP_DODAWANIE, bajty_macierzy(dlug, 3));
+    if (*dlug != *m.dlug)
+    {
+        cout << "Macierze posiadaja rozne dlugosci" << endl;
+        return *this;
+    }
+    odlacz();
+    int n = *dlug;
+    int blad = wiersze_z_bledem(n, [&](int i, int& blad_bloku) {
+        int* w = mac[i];
+        const int* v = m.mac[i];
+        for (int j = 0; j < n; j++)
+        {
+            w[j] = P::zwez((long long)w[j] + v[j], blad_bloku);
         }
+    });
+    if constexpr (is_same_v<P, sprawdzanie>)
+    {
+        przepelniona = blad != 0;
     }
+    return *this;
 }
 
 /**
- * @brief Destruktor klasy matrix.
+ * @brief Mnoży macierz przez macierz m z wybraną polityką arytmetyki.
+ * @tparam P Polityka arytmetyki (zawijanie, nasycanie lub sprawdzanie).
+ * @param m Macierz do pomnożenia.
+ * @return Referencja do obiektu matrix.
  */
-matrix::~matrix(void)
+template <class P>
+matrix& matrix::mnoz(matrix& m)
 {
-    if (mac != nullptr)
+    MIERZ_OPERACJE(OP_MNOZENIE, bajty_macierzy(dlug, 3));
+    if (*dlug != *m.dlug)
+    {
+        cout << "Macierze posiadaja rozne dlugosci" << endl;
+        return *this;
+    }
+    int blad = 0;
+    int n = *dlug;
+    int** wynik = nowe_wiersze(n);
+    bufory_mnozenia bufory;
+    if constexpr (is_same_v<P, zawijanie>)
+    {
+        mnoz_wiersze_zawijanie(mac, m.mac, wynik, n, bufory);
+    }
+    else
+    {
+        mnoz_wiersze_p<P>(mac, m.mac, wynik, n, blad, bufory);
+    }
+    przejmij(wynik, n);
+    if constexpr (is_same_v<P, sprawdzanie>)
     {
-        for (int i = 0; i < *dlug; i++)
+        przepelniona = blad != 0;
+    }
+    return *this;
+}
+
+/**
+ * @brief Mnoży macierz przez liczbę z wybraną polityką arytmetyki.
+ * @tparam P Polityka arytmetyki (zawijanie, nasycanie lub sprawdzanie).
+ * @param a Liczba do pomnożenia.
+ * @return Referencja do obiektu matrix.
+ */
+template <class P>
+matrix& matrix::mnoz(int a)
+{
+    MIERZ_OPERACJE(OP_SKALAR, bajty_macierzy(dlug, 2));
+    odlacz();
+    int n = *dlug;
+    int blad = wiersze_z_bledem(n, [&](int i, int& blad_bloku) {
+        int* w = mac[i];
+        for (int j = 0; j < n; j++)
         {
-            delete[] mac[i];
+            w[j] = P::zwez((long long)w[j] * a, blad_bloku);
         }
-        delete[] mac;
+    });
+    if constexpr (is_same_v<P, sprawdzanie>)
+    {
+        przepelniona = blad != 0;
     }
+    return *this;
 }
 
 /**
- * @brief Alokuje pamięć dla macierzy o rozmiarze n x n.
- * @param n Rozmiar macierzy.
+ * @brief Dodaje liczbę do każdego elementu z wybraną polityką arytmetyki.
+ * @tparam P Polityka arytmetyki (zawijanie, nasycanie lub sprawdzanie).
+ * @param a Liczba do dodania.
  * @return Referencja do obiektu matrix.
  */
-matrix& matrix::alokuj(int n)
+template <class P>
+matrix& matrix::dodaj(int a)
+{
+    MIERZ_OPERACJE(OP_SKALAR, bajty_macierzy(dlug, 2));
+    odlacz();
+    int n = *dlug;
+    int blad = wiersze_z_bledem(n, [&](int i, int& blad_bloku) {
+        int* w = mac[i];
+        for (int j = 0; j < n; j++)
+        {
+            w[j] = P::zwez((long long)w[j] + a, blad_bloku);
+        }
+    });
+    if constexpr (is_same_v<P, sprawdzanie>)
+    {
+        przepelniona = blad != 0;
+    }
+    return *this;
+}
+
+template matrix& matrix::dodaj<zawijanie>(matrix& m);
+template matrix& matrix::dodaj<nasycanie>(matrix& m);
+template matrix& matrix::dodaj<sprawdzanie>(matrix& m);
+template matrix& matrix::mnoz<zawijanie>(matrix& m);
+template matrix& matrix::mnoz<nasycanie>(matrix& m);
+template matrix& matrix::mnoz<sprawdzanie>(matrix& m);
+template matrix& matrix::mnoz<zawijanie>(int a);
+template matrix& matrix::mnoz<nasycanie>(int a);
+template matrix& matrix::mnoz<sprawdzanie>(int a);
+template matrix& matrix::dodaj<zawijanie>(int a);
+template matrix& matrix::dodaj<nasycanie>(int a);
+template matrix& matrix::dodaj<sprawdzanie>(int a);
+
+/**
+ * @brief Zwraca informację o przepełnieniu w ostatniej operacji z polityką sprawdzanie.
+ * @return true jeśli wystąpiło przepełnienie, false w przeciwnym razie.
+ */
+bool matrix::przepelnienie(void)
+{
+    return przepelniona;
+}
+
+/**
+ * @brief Oblicza iloczyn this * m z akumulacją i wynikiem 64-bitowym.
+ * Sumy są liczone dokładnie; wynik jest dokładny, dopóki |suma| < 2^63, a poza tym zakresem
+ * nasycany do LLONG_MIN lub LLONG_MAX.
+ * @param m Macierz do pomnożenia.
+ * @param wynik Tablica n * n liczb long long na wynik (wierszami).
+ */
+void matrix::iloczyn_szeroki(matrix& m, long long* wynik)
+{
+    if (*dlug != *m.dlug)
+    {
+        cout << "Macierze posiadaja rozne dlugosci" << endl;
+        return;
+    }
+    int n = *dlug;
+    vector<suma_szeroka> suma(n);
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < n; j++)
+        {
+            suma[j] = suma_szeroka();
+        }
+        for (int k = 0; k < n; k++)
+        {
+            long long aik = mac[i][k];
+            const int* bk = m.mac[k];
+            for (int j = 0; j < n; j++)
+            {
+                suma[j].dodaj(aik * bk[j]);
+            }
+        }
+        long long* wi = wynik + (long long)i * n;
+        for (int j = 0; j < n; j++)
+        {
+            wi[j] = suma[j].wartosc();
+        }
+    }
+}
+
+/**
+ * @brief Zwraca sumę wszystkich elementów macierzy.
+ * Sumy częściowe bloków wierszy są łączone w stałej kolejności.
+ * @return Suma elementów w akumulatorze 64-bitowym.
+ */
+long long matrix::suma(void)
 {
-    if (mac != nullptr) {
-        if (*dlug < n) {
-            for (int i = 0; i < *dlug; i++) {
-                delete[] mac[i];
+    int n = *dlug;
+    vector<long long> czesciowe(liczba_blokow(n));
+    rownolegle(n, (long long)n * n, [&](int b, int poczatek, int koniec) {
+        long long s = 0;
+        for (int i = poczatek; i < koniec; i++)
+        {
+            const int* w = mac[i];
+            for (int j = 0; j < n; j++)
+            {
+                s += w[j];
             }
-            delete[] mac;
-            delete dlug;
         }
+        czesciowe[b] = s;
+    });
+    long long s = 0;
+    for (size_t b = 0; b < czesciowe.size(); b++)
+    {
+        s += czesciowe[b];
     }
-
-    mac = new int* [n];
-    for (int i = 0; i < n; i++) {
-        mac[i] = new int[n];
-    }
-
-    dlug = new int(n);
-    *dlug = n;
-    return *this;
+    return s;
 }
 
 /**
- * @brief Wstawia wartość do macierzy w określonej pozycji.
- * @param x Wiersz.
- * @param y Kolumna.
- * @param wartosc Wartość do wstawienia.
- * @return Referencja do obiektu matrix.
+ * @brief Zwraca najmniejszy element macierzy.
+ * @return Najmniejsza wartość.
  */
-matrix& matrix::wstaw(int x, int y, int wartosc)
+int matrix::minimum(void)
 {
-    mac[x][y] = wartosc;
-    return *this;
+    int x, y;
+    return ekstremum(mac, *dlug, false, x, y);
 }
 
 /**
- * @brief Zwraca wartość z macierzy z określonej pozycji.
- * @param x Wiersz.
- * @param y Kolumna.
- * @return Wartość z macierzy.
+ * @brief Zwraca największy element macierzy.
+ * @return Największa wartość.
  */
-int matrix::pokaz(int x, int y)
+int matrix::maksimum(void)
 {
-    return mac[x][y];
+    int x, y;
+    return ekstremum(mac, *dlug, true, x, y);
 }
 
 /**
- * @brief Odwraca macierz (transpozycja).
- * @return Referencja do obiektu matrix.
+ * @brief Wyznacza pozycję najmniejszego elementu (pierwszego w kolejności wierszy).
+ * @param x Wiersz znalezionego elementu.
+ * @param y Kolumna znalezionego elementu.
+ * @return Najmniejsza wartość.
  */
-matrix& matrix::dowroc(void)
+int matrix::argmin(int& x, int& y)
 {
-    for (int i = 0; i < *dlug; i++) {
-        for (int j = i + 1; j < *dlug; j++) {
-            swap(mac[i][j], mac[j][i]);
-        }
-    }
-    return *this;
+    return ekstremum(mac, *dlug, false, x, y);
 }
 
 /**
- * @brief Wypełnia macierz losowymi wartościami.
- * @return Referencja do obiektu matrix.
+ * @brief Wyznacza pozycję największego elementu (pierwszego w kolejności wierszy).
+ * @param x Wiersz znalezionego elementu.
+ * @param y Kolumna znalezionego elementu.
+ * @return Największa wartość.
  */
-matrix& matrix::losuj(void)
+int matrix::argmax(int& x, int& y)
 {
-    srand(time(nullptr));
-
-    for (int i = 0; i < *dlug; i++)
-    {
-        for (int j = 0; j < *dlug; j++)
-        {
-            mac[i][j] = rand() % 10;
-        }
-    }
-    return *this;
+    return ekstremum(mac, *dlug, true, x, y);
 }
 
 /**
- * @brief Wypełnia macierz losowymi wartościami w określonej liczbie komórek.
- * @param x Liczba komórek do wypełnienia.
- * @return Referencja do obiektu matrix.
+ * @brief Zwraca ślad macierzy (sumę elementów na przekątnej).
+ * @return Ślad macierzy.
  */
-matrix& matrix::losuj(int x)
+long long matrix::slad(void)
 {
-    srand(time(nullptr));
-    int t1;
-    int t2;
-    for (int i = 0; i < x; i++) {
-        t1 = rand() % *dlug;
-        t2 = rand() % *dlug;
-        mac[t1][t2] = rand() % 10;
+    long long s = 0;
+    for (int i = 0; i < *dlug; i++)
+    {
+        s += mac[i][i];
     }
-    return *this;
+    return s;
 }
 
 /**
- * @brief Ustawia wartości na przekątnej macierzy.
- * @param t Tablica wartości do ustawienia na przekątnej.
- * @return Referencja do obiektu matrix.
+ * @brief Zwraca normę Frobeniusa macierzy.
+ * @return Pierwiastek z sumy kwadratów elementów.
  */
-matrix& matrix::diagonalna(int* t)
+double matrix::norma_frobeniusa(void)
 {
-    for (int i = 0; i < *dlug; i++)
-    {
-        mac[i][i] = t[i];
-    }
-    for (int i = 0; i < *dlug; i++)
-    {
-        for (int j = 0; j < *dlug; j++)
+    int n = *dlug;
+    vector<double> czesciowe(liczba_blokow(n));
+    rownolegle(n, (long long)n * n, [&](int b, int poczatek, int koniec) {
+        double s = 0;
+        for (int i = poczatek; i < koniec; i++)
         {
-            if (i != j)
+            const int* w = mac[i];
+            for (int j = 0; j < n; j++)
             {
-                mac[i][j] = 0;
+                s += (double)w[j] * w[j];
             }
         }
+        czesciowe[b] = s;
+    });
+    double s = 0;
+    for (size_t b = 0; b < czesciowe.size(); b++)
+    {
+        s += czesciowe[b];
     }
-    return *this;
+    return sqrt(s);
 }
 
 /**
- * @brief Ustawia wartości na przekątnej macierzy z przesunięciem.
- * @param k Przesunięcie przekątnej.
- * @param t Tablica wartości do ustawienia na przekątnej.
- * @return Referencja do obiektu matrix.
+ * @brief Zwraca normę L1 macierzy (największą sumę modułów w kolumnie).
+ * @return Norma L1.
  */
-matrix& matrix::diagonalna_k(int k, int* t)
+long long matrix::norma_1(void)
 {
-    for (int i = 0; i < *dlug; i++)
-    {
-        for (int j = 0; j < *dlug; j++)
-        {
-            mac[i][j] = 0;
-        }
-    }
-    if (k != 0) {
-        if (k > 0)
+    int n = *dlug;
+    int bloki = liczba_blokow(n);
+    vector<long long> czesciowe((size_t)bloki * n);
+    rownolegle(n, (long long)n * n, [&](int b, int poczatek, int koniec) {
+        long long* s = &czesciowe[(size_t)b * n];
+        for (int i = poczatek; i < koniec; i++)
         {
-            for (int i = 0; i < *dlug - k; i++)
+            const int* w = mac[i];
+            for (int j = 0; j < n; j++)
             {
-                mac[i][i + k] = t[i + k];
+                s[j] += llabs(w[j]);
             }
         }
-        else {
-            for (int i = 0; i < *dlug; i++)
-            {
-                mac[i][i + k] = t[i + k];
-            }
+    });
+    long long wynik = 0;
+    for (int j = 0; j < n; j++)
+    {
+        long long s = 0;
+        for (int b = 0; b < bloki; b++)
+        {
+            s += czesciowe[(size_t)b * n + j];
         }
-
-    }
-    else {
-        diagonalna(t);
+        wynik = s > wynik ? s : wynik;
     }
-    return *this;
+    return wynik;
 }
 
 /**
- * @brief Ustawia wartości w kolumnie macierzy.
- * @param x Numer kolumny.
- * @param t Tablica wartości do ustawienia w kolumnie.
- * @return Referencja do obiektu matrix.
+ * @brief Zwraca normę L-nieskończoność macierzy (największą sumę modułów w wierszu).
+ * @return Norma L-nieskończoność.
  */
-matrix& matrix::kolumna(int x, int* t)
+long long matrix::norma_inf(void)
 {
-    for (int i = 0; i < *dlug; i++)
+    int n = *dlug;
+    vector<long long> czesciowe(liczba_blokow(n));
+    rownolegle(n, (long long)n * n, [&](int b, int poczatek, int koniec) {
+        long long najwieksza = 0;
+        for (int i = poczatek; i < koniec; i++)
+        {
+            const int* w = mac[i];
+            long long s = 0;
+            for (int j = 0; j < n; j++)
+            {
+                s += llabs(w[j]);
+            }
+            najwieksza = s > najwieksza ? s : najwieksza;
+        }
+        czesciowe[b] = najwieksza;
+    });
+    long long wynik = 0;
+    for (size_t b = 0; b < czesciowe.size(); b++)
     {
-        mac[i][x] = t[i];
+        wynik = czesciowe[b] > wynik ? czesciowe[b] : wynik;
     }
-    return *this;
+    return wynik;
 }
 
 /**
- * @brief Ustawia wartości w wierszu macierzy.
- * @param y Numer wiersza.
- * @param t Tablica wartości do ustawienia w wierszu.
- * @return Referencja do obiektu matrix.
+ * @brief Oblicza sumy wszystkich wierszy.
+ * @param t Tablica n liczb na wyniki.
  */
-matrix& matrix::wiersz(int y, int* t)
+void matrix::sumy_wierszy(long long* t)
 {
-    for (int i = 0; i < *dlug; i++)
-    {
-        mac[y][i] = t[i];
-    }
-    return *this;
+    int n = *dlug;
+    rownolegle(n, (long long)n * n, [&](int b, int poczatek, int koniec) {
+        for (int i = poczatek; i < koniec; i++)
+        {
+            const int* w = mac[i];
+            long long s = 0;
+            for (int j = 0; j < n; j++)
+            {
+                s += w[j];
+            }
+            t[i] = s;
+        }
+    });
 }
 
 /**
- * @brief Ustawia wartości na przekątnej macierzy na 1, a pozostałe na 0.
- * @return Referencja do obiektu matrix.
+ * @brief Oblicza sumy wszystkich kolumn.
+ * Każdy blok wierszy sumuje do własnego wektora, a wektory są łączone w kolejności bloków.
+ * @param t Tablica n liczb na wyniki.
  */
-matrix& matrix::przekatna(void)
+void matrix::sumy_kolumn(long long* t)
 {
-    for (int i = 0; i < *dlug; i++)
-    {
-        for (int j = 0; j < *dlug; j++)
+    int n = *dlug;
+    int bloki = liczba_blokow(n);
+    vector<long long> czesciowe((size_t)bloki * n);
+    rownolegle(n, (long long)n * n, [&](int b, int poczatek, int koniec) {
+        long long* s = &czesciowe[(size_t)b * n];
+        for (int i = poczatek; i < koniec; i++)
         {
-            if (i != j)
+            const int* w = mac[i];
+            for (int j = 0; j < n; j++)
             {
-                mac[i][j] = 0;
-            }
-            else {
-                mac[i][j] = 1;
+                s[j] += w[j];
             }
         }
+    });
+    for (int j = 0; j < n; j++)
+    {
+        t[j] = 0;
+    }
+    for (int b = 0; b < bloki; b++)
+    {
+        const long long* s = &czesciowe[(size_t)b * n];
+        for (int j = 0; j < n; j++)
+        {
+            t[j] += s[j];
+        }
     }
-    return *this;
 }
 
 /**
- * @brief Ustawia wartości pod przekątną macierzy na 1, a pozostałe na 0.
- * @return Referencja do obiektu matrix.
+ * @brief Eliminacja Bareissa bez ułamków w liczbach 64-bitowych.
+ * Wszystkie elementy pośrednie są minorami macierzy, więc dzielenia są dokładne;
+ * przerywa, gdy iloczyn pośredni przekroczyłby 2^62.
+ * @param wyznacznik Wynik: wyznacznik macierzy.
+ * @return Rząd macierzy lub -1 przy przepełnieniu.
  */
-matrix& matrix::pod_przekatna(void)
+int matrix::bareiss(long long& wyznacznik) const
 {
-    for (int i = 0; i < *dlug; i++)
+    int n = dlug == nullptr ? 0 : *dlug;
+    MIERZ_OPERACJE(OP_ELIMINACJA, (long long)n * n * n / 3 * 2 * sizeof(long long));
+    vector<long long> a((size_t)n * n);
+    for (int i = 0; i < n; i++)
     {
-        for (int j = 0; j < *dlug; j++)
+        for (int j = 0; j < n; j++)
+        {
+            a[(size_t)i * n + j] = mac[i][j];
+        }
+    }
+    long long poprzedni = 1;
+    long long znak = 1;
+    int r = 0;
+    for (int c = 0; c < n && r < n; c++)
+    {
+        int k = r;
+        while (k < n && a[(size_t)k * n + c] == 0)
+        {
+            k++;
+        }
+        if (k == n)
+        {
+            continue;
+        }
+        long long* w = &a[(size_t)r * n];
+        if (k != r)
         {
-            if (i > j)
+            long long* v = &a[(size_t)k * n];
+            for (int j = c; j < n; j++)
             {
-                mac[i][j] = 1;
+                long long t = w[j];
+                w[j] = v[j];
+                v[j] = t;
             }
-            else {
-                mac[i][j] = 0;
+            znak = -znak;
+        }
+        long long piwot = w[c];
+        for (int i = r + 1; i < n; i++)
+        {
+            long long* v = &a[(size_t)i * n];
+            long long f = v[c];
+            for (int j = c + 1; j < n; j++)
+            {
+                long long x;
+                long long y;
+                if (!iloczyn_bareissa(piwot, v[j], x) || !iloczyn_bareissa(f, w[j], y))
+                {
+                    return -1;
+                }
+                v[j] = (x - y) / poprzedni;
             }
+            v[c] = 0;
         }
+        poprzedni = piwot;
+        r++;
     }
-    return *this;
+    wyznacznik = r < n ? 0 : (n == 0 ? 1 : znak * a[(size_t)n * n - 1]);
+    return r;
 }
 
 /**
- * @brief Ustawia wartości nad przekątną macierzy na 1, a pozostałe na 0.
- * @return Referencja do obiektu matrix.
+ * @brief Zwraca wyznacznik macierzy modulo liczba pierwsza.
+ * @param p Liczba pierwsza mniejsza od 2^31.
+ * @return Wyznacznik modulo p z przedziału [0, p).
  */
-matrix& matrix::nad_przekatna(void)
+unsigned int matrix::wyznacznik_modulo(unsigned int p) const
 {
-    for (int i = 0; i < *dlug; i++)
+    if (p < 2 || p >= (1u << 31))
     {
-        for (int j = 0; j < *dlug; j++)
-        {
-            if (i < j)
-            {
-                mac[i][j] = 1;
-            }
-            else {
-                mac[i][j] = 0;
-            }
-        }
+        cout << "Modul musi byc liczba pierwsza mniejsza od 2^31" << endl;
+        return 0;
     }
-    return *this;
+    unsigned int wynik;
+    eliminacja_modulo(mac, dlug == nullptr ? 0 : *dlug, p, wynik);
+    return wynik;
 }
 
 /**
- * @brief Ustawia wartości w macierzy w formie szachownicy.
- * @return Referencja do obiektu matrix.
+ * @brief Zwraca rząd macierzy nad ciałem Z_p.
+ * @param p Liczba pierwsza mniejsza od 2^31.
+ * @return Rząd modulo p (nie większy niż rząd nad liczbami wymiernymi).
  */
-matrix& matrix::szachownica(void)
+int matrix::rzad_modulo(unsigned int p) const
 {
-    for (int i = 0; i < *dlug; i++)
+    if (p < 2 || p >= (1u << 31))
     {
-        for (int j = 0; j < *dlug; j++)
-        {
-            if ((i + j) % 2 != 0)
-            {
-                mac[i][j] = 1;
-            }
-            else {
-                mac[i][j] = 0;
-            }
-        }
+        cout << "Modul musi byc liczba pierwsza mniejsza od 2^31" << endl;
+        return 0;
     }
-    return *this;
+    unsigned int wyznacznik;
+    return eliminacja_modulo(mac, dlug == nullptr ? 0 : *dlug, p, wyznacznik);
 }
 
 /**
- * @brief Operator dodawania macierzy.
- * @param m Macierz do dodania.
- * @return Referencja do obiektu matrix.
+ * @brief Zwraca dokładny wyznacznik w zapisie dziesiętnym.
+ * Gdy eliminacja Bareissa się przepełni, wyznacznik jest liczony modulo tylu liczb pierwszych
+ * bliskich 2^31, by ich iloczyn przekroczył podwojone ograniczenie Hadamarda, równolegle
+ * dla różnych liczb pierwszych, i odtwarzany z chińskiego twierdzenia o resztach.
+ * @return Wyznacznik (dowolnej długości).
  */
-matrix& matrix::operator+(matrix& m)
+string matrix::wyznacznik(void) const
 {
-    matrix* temp = new matrix(*dlug);
-    for (int i = 0; i < *dlug; i++)
+    long long w;
+    if (bareiss(w) >= 0)
     {
-        for (int j = 0; j < *dlug; j++)
-        {
-            temp->mac[i][j] = mac[i][j] + m.mac[i][j];
-        }
+        return to_string(w);
     }
-    *this = *temp;
-    return *this;
+    int n = *dlug;
+    vector<unsigned int> pierwsze = liczby_pierwsze(log2_hadamarda(mac, n) + 2);
+    int k = (int)pierwsze.size();
+    vector<unsigned int> reszty(k);
+    rownolegle_zadania(k, (long long)k * n * n * n / 3, [&](int i) {
+        eliminacja_modulo(mac, n, pierwsze[i], reszty[i]);
+    });
+    return z_reszt(reszty, pierwsze);
 }
 
 /**
- * @brief Operator mnożenia macierzy.
- * @param m Macierz do pomnożenia.
- * @return Referencja do obiektu matrix.
+ * @brief Zwraca dokładny rząd macierzy nad liczbami wymiernymi.
+ * Przy przepełnieniu eliminacji Bareissa jest to największy rząd modulo liczb pierwszych,
+ * których iloczyn przekracza ograniczenie Hadamarda dowolnego niezerowego minora.
+ * Liczby pierwsze są sprawdzane porcjami po liczba_watkow() do znalezienia pełnego rzędu.
+ * @return Rząd macierzy.
  */
-matrix& matrix::operator*(matrix& m)
+int matrix::rzad(void) const
 {
-    if (*dlug != *m.dlug)
+    long long w;
+    int wynik = bareiss(w);
+    if (wynik >= 0)
     {
-        cout << "Macierze posiadaja rozne dlugosci" << endl;
-        return *this;
+        return wynik;
     }
-    matrix* temp = new matrix(*dlug);
-    for (int i = 0; i < *dlug; i++)
+    int n = *dlug;
+    vector<unsigned int> pierwsze = liczby_pierwsze(log2_hadamarda(mac, n) + 1);
+    int k = (int)pierwsze.size();
+    int T = liczba_watkow();
+    vector<int> rzedy(k);
+    for (int od = 0; od < k && wynik < n; od += T)
     {
-        for (int j = 0; j < *dlug; j++)
+        int ile = od + T < k ? T : k - od;
+        rownolegle_zadania(ile, (long long)ile * n * n * n / 3, [&](int i) {
+            unsigned int wyznacznik;
+            rzedy[od + i] = eliminacja_modulo(mac, n, pierwsze[od + i], wyznacznik);
+        });
+        for (int i = od; i < od + ile; i++)
         {
-            temp->mac[i][j] = 0;
-            for (int k = 0; k < *dlug; k++)
-            {
-                temp->mac[i][j] += (mac[i][j] * m.mac[i][k]);
-            }
+            wynik = rzedy[i] > wynik ? rzedy[i] : wynik;
         }
     }
-    *this = *temp;
-    return *this;
+    return wynik;
 }
 
 /**
- * @brief Operator dodawania liczby do macierzy.
+ * @brief Sprawdza, czy wyznacznik macierzy jest różny od zera.
+ * Zwykle wystarcza jedna eliminacja modulo liczba pierwsza; pełne sprawdzenie jest
+ * potrzebne tylko wtedy, gdy wyznacznik wyjdzie podzielny przez tę liczbę.
+ * @return true jeśli macierz jest odwracalna nad liczbami wymiernymi.
+ */
+bool matrix::odwracalna(void) const
+{
+    int n = dlug == nullptr ? 0 : *dlug;
+    unsigned int wyznacznik;
+    if (eliminacja_modulo(mac, n, liczby_pierwsze(0)[0], wyznacznik) == n)
+    {
+        return true;
+    }
+    return rzad() == n;
+}
+
+/**
+ * @brief Operator dodawania liczby do macierzy (z zawijaniem modulo 2^32).
  * @param a Liczba do dodania.
  * @return Referencja do obiektu matrix.
  */
 matrix& matrix::operator+(int a)
 {
-    matrix* temp = new matrix(*dlug);
-    for (int i = 0; i < *dlug; i++)
-    {
-        for (int j = 0; j < *dlug; j++)
-        {
-            temp->mac[i][j] = mac[i][j] + a;
-        }
-    }
-    *this = *temp;
-    return *this;
+    return dodaj<zawijanie>(a);
 }
 
 /**
- * @brief Operator mnożenia macierzy przez liczbę.
+ * @brief Operator mnożenia macierzy przez liczbę (z zawijaniem modulo 2^32).
  * @param a Liczba do pomnożenia.
  * @return Referencja do obiektu matrix.
  */
 matrix& matrix::operator*(int a)
 {
-    matrix* temp = new matrix(*dlug);
-    for (int i = 0; i < *dlug; i++)
-    {
-        for (int j = 0; j < *dlug; j++)
-        {
-            temp->mac[i][j] = mac[i][j] * a;
-        }
-    }
-    *this = *temp;
-    return *this;
+    return mnoz<zawijanie>(a);
 }
 
 /**
- * @brief Operator odejmowania liczby od macierzy.
+ * @brief Operator odejmowania liczby od macierzy (z zawijaniem modulo 2^32).
  * @param a Liczba do odjęcia.
  * @return Referencja do obiektu matrix.
  */
 matrix& matrix::operator-(int a)
 {
-    matrix* temp = new matrix(*dlug);
-    for (int i = 0; i < *dlug; i++)
-    {
-        for (int j = 0; j < *dlug; j++)
-        {
-            temp->mac[i][j] = mac[i][j] - a;
-        }
-    }
-    *this = *temp;
-    return *this;
+    return dodaj<zawijanie>((int)(0u - (unsigned int)a));
 }
 
 /**
- * @brief Operator dodawania liczby do macierzy (globalny).
+ * @brief Operator dodawania liczby do macierzy (globalny, z zawijaniem modulo 2^32).
  * @param a Liczba do dodania.
  * @param m Macierz.
  * @return Nowa macierz będąca wynikiem dodawania.
  */
 matrix operator+(int a, matrix& m)
 {
-    matrix* temp = new matrix(*m.dlug);
+    MIERZ_OPERACJE(OP_SKALAR, bajty_macierzy(m.dlug, 2));
+    matrix temp(*m.dlug);
     for (int i = 0; i < *m.dlug; i++)
     {
         for (int j = 0; j < *m.dlug; j++)
         {
-            temp->mac[i][j] = a + m.mac[i][j];
+            temp.mac[i][j] = (int)((unsigned int)a + (unsigned int)m.mac[i][j]);
         }
     }
-    return *temp;
+    return temp;
 }
 
 /**
- * @brief Operator mnożenia liczby przez macierz (globalny).
+ * @brief Operator mnożenia liczby przez macierz (globalny, z zawijaniem modulo 2^32).
  * @param a Liczba do pomnożenia.
  * @param m Macierz.
  * @return Nowa macierz będąca wynikiem mnożenia.
  */
 matrix operator*(int a, matrix& m)
 {
-    matrix* temp = new matrix(*m.dlug);
+    MIERZ_OPERACJE(OP_SKALAR, bajty_macierzy(m.dlug, 2));
+    matrix temp(*m.dlug);
     for (int i = 0; i < *m.dlug; i++)
     {
         for (int j = 0; j < *m.dlug; j++)
         {
-            temp->mac[i][j] = a * m.mac[i][j];
+            temp.mac[i][j] = (int)((unsigned int)a * (unsigned int)m.mac[i][j]);
         }
     }
-    return *temp;
+    return temp;
 }
 
 /**
- * @brief Operator odejmowania liczby od macierzy (globalny).
+ * @brief Operator odejmowania liczby od macierzy (globalny, z zawijaniem modulo 2^32).
  * @param a Liczba do odjęcia.
  * @param m Macierz.
  * @return Nowa macierz będąca wynikiem odejmowania.
  */
 matrix operator-(int a, matrix& m)
 {
-    matrix* temp = new matrix(*m.dlug);
+    MIERZ_OPERACJE(OP_SKALAR, bajty_macierzy(m.dlug, 2));
+    matrix temp(*m.dlug);
     for (int i = 0; i < *m.dlug; i++)
     {
         for (int j = 0; j < *m.dlug; j++)
         {
-            temp->mac[i][j] = a - m.mac[i][j];
+            temp.mac[i][j] = (int)((unsigned int)a - (unsigned int)m.mac[i][j]);
         }
     }
-    return *temp;
+    return temp;
 }
 
 /**
- * @brief Operator inkrementacji macierzy.
+ * @brief Operator inkrementacji macierzy (z zawijaniem modulo 2^32).
  * @return Referencja do obiektu matrix.
  */
 matrix& matrix::operator++(int)
 {
-    matrix* temp = new matrix(*dlug);
-    for (int i = 0; i < *dlug; i++)
-    {
-        for (int j = 0; j < *dlug; j++)
-        {
-            temp->mac[i][j] = mac[i][j] + 1;
-        }
-    }
-    *this = *temp;
-    return *this;
+    return dodaj<zawijanie>(1);
 }
 
 /**
- * @brief Operator dekrementacji macierzy.
+ * @brief Operator dekrementacji macierzy (z zawijaniem modulo 2^32).
  * @return Referencja do obiektu matrix.
  */
 matrix& matrix::operator--(int)
 {
-    matrix* temp = new matrix(*dlug);
-    for (int i = 0; i < *dlug; i++)
-    {
-        for (int j = 0; j < *dlug; j++)
-        {
-            temp->mac[i][j] = mac[i][j] - 1;
-        }
-    }
-    *this = *temp;
-    return *this;
+    return dodaj<zawijanie>(-1);
 }
 
 /**
- * @brief Operator dodawania liczby do macierzy.
+ * @brief Operator dodawania liczby do macierzy (z zawijaniem modulo 2^32).
  * @param a Liczba do dodania.
  * @return Referencja do obiektu matrix.
  */
 matrix& matrix::operator+=(int a)
 {
-    matrix* temp = new matrix(*dlug);
-    for (int i = 0; i < *dlug; i++)
-    {
-        for (int j = 0; j < *dlug; j++)
-        {
-            temp->mac[i][j] = mac[i][j] + a;
-        }
-    }
-    *this = *temp;
-    return *this;
+    return dodaj<zawijanie>(a);
 }
 
 /**
- * @brief Operator odejmowania liczby od macierzy.
+ * @brief Operator odejmowania liczby od macierzy (z zawijaniem modulo 2^32).
  * @param a Liczba do odjęcia.
  * @return Referencja do obiektu matrix.
  */
 matrix& matrix::operator-=(int a)
 {
-    matrix* temp = new matrix(*dlug);
-    for (int i = 0; i < *dlug; i++)
-    {
-        for (int j = 0; j < *dlug; j++)
-        {
-            temp->mac[i][j] = mac[i][j] - a;
-        }
-    }
-    *this = *temp;
-    return *this;
+    return dodaj<zawijanie>((int)(0u - (unsigned int)a));
 }
 
 /**
- * @brief Operator mnożenia macierzy przez liczbę.
+ * @brief Operator mnożenia macierzy przez liczbę (z zawijaniem modulo 2^32).
  * @param a Liczba do pomnożenia.
  * @return Referencja do obiektu matrix.
  */
 matrix& matrix::operator*=(int a)
 {
-    matrix* temp = new matrix(*dlug);
-    for (int i = 0; i < *dlug; i++)
-    {
-        for (int j = 0; j < *dlug; j++)
-        {
-            temp->mac[i][j] = mac[i][j] * a;
-        }
-    }
-    *this = *temp;
-    return *this;
+    return mnoz<zawijanie>(a);
 }
 
 /**
@@ -613,16 +2737,16 @@ matrix& matrix::operator*=(int a)
  */
 matrix& matrix::operator()(double value)
 {
+    MIERZ_OPERACJE(OP_SKALAR, bajty_macierzy(dlug, 2));
+    odlacz();
     int intvalue = (int)value;
-    matrix* temp = new matrix(*dlug);
     for (int i = 0; i < *dlug; i++)
     {
         for (int j = 0; j < *dlug; j++)
         {
-            temp->mac[i][j] = mac[i][j] + intvalue;
+            mac[i][j] += intvalue;
         }
     }
-    *this = *temp;
     return *this;
 }
 
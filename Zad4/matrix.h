@@ -1,6 +1,11 @@
 #pragma once
 #include <iostream>
 #include <ostream>
+#include <span>
+#include <string>
+#include <atomic>
+#include "arytmetyka.h"
+#include "pamiec.h"
 using namespace std;
 
 /**
@@ -9,8 +14,55 @@ using namespace std;
  */
 class matrix {
 private:
-    int* dlug; ///< Wskanik na dugo macierzy.
-    int** mac; ///< Wskanik na tablic wskanikw reprezentujcych macierz.
+    int* dlug = nullptr; ///< Wskanik na dugo macierzy.
+    int** mac = nullptr; ///< Wskanik na tablic wskanikw reprezentujcych macierz.
+    bool przepelniona = false; ///< Czy ostatnia operacja z polityk sprawdzanie wykrya przepenienie.
+    atomic<int>* licznik = nullptr; ///< Liczba obiektw wspdzielcych wiersze (kopiowanie przy zapisie).
+    int poj = 0; ///< Pojemno bufora: najwikszy rozmiar n, dla ktrego alokuj nie alokuje pamici.
+
+    /**
+     * @brief Zwalnia udzia w buforze; bufor jest usuwany przez ostatniego waciciela.
+     */
+    void zwolnij(void);
+
+    /**
+     * @brief Tworzy prywatn kopi wspdzielonego bufora.
+     */
+    void sklonuj(void);
+
+    /**
+     * @brief Przejmuje na wasno wiersze o rozmiarze n, zwalniajc dotychczasowy bufor.
+     * @param wiersze Tablica wskanikw na wiersze w jednym cigym buforze (jak z nowe_wiersze).
+     * @param n Rozmiar macierzy.
+     */
+    void przejmij(int** wiersze, int n);
+
+    /**
+     * @brief Ustawia macierz na bufor tylko do odczytu (np. segment pamici wspdzielonej) bez kopiowania.
+     * Bufor jest zwalniany przez zwolnij_bufor po odejciu ostatniego waciciela; kady zapis najpierw go kopiuje.
+     * @param dane Bufor n x n udostpniony przez bufor_wspolny.
+     * @param n Rozmiar macierzy.
+     */
+    void przejmij_do_odczytu(int* dane, int n);
+
+    /**
+     * @brief Zapewnia wyczn wasno bufora przed zapisem (kopiowanie przy zapisie).
+     */
+    void odlacz(void)
+    {
+        if (licznik != nullptr && licznik->load(memory_order_acquire) > 1)
+        {
+            sklonuj();
+        }
+    }
+
+    friend class macierz_trojkatna;
+    friend class macierz_wzorcowa;
+    friend class szablon_splotu;
+    friend class tablica_sum;
+    friend class czytelnik_macierzy;
+    friend class wydawca_macierzy;
+    friend class macierz_skompresowana;
 
 public:
     /**
@@ -33,9 +85,29 @@ public:
 
     /**
      * @brief Konstruktor kopiujcy klasy matrix.
+     * Kopia wspdzieli bufor z m, dopki jedna z nich nie zostanie zmodyfikowana.
      * @param m Obiekt matrix, ktry ma zosta skopiowany.
      */
-    matrix(matrix& m);
+    matrix(const matrix& m);
+
+    /**
+     * @brief Operator przypisania; podobnie jak kopia wspdzieli bufor do pierwszego zapisu.
+     * @param m Obiekt matrix, ktry ma zosta przypisany.
+     * @return Referencja do obiektu matrix.
+     */
+    matrix& operator=(const matrix& m);
+
+    /**
+     * @brief Sprawdza, czy macierz wspdzieli bufor z inn kopi.
+     * @return true jeli bufor jest wspdzielony.
+     */
+    bool wspoldzielona(void) const;
+
+    /**
+     * @brief Wymienia zawarto (bufor, rozmiar i pojemno) z macierz m bez kopiowania danych.
+     * @param m Macierz do wymiany.
+     */
+    void zamien(matrix& m);
 
     /**
      * @brief Destruktor klasy matrix.
@@ -44,11 +116,39 @@ public:
 
     /**
      * @brief Alokuje pami dla macierzy o rozmiarze n x n.
+     * Jeli bufor nie jest wspdzielony i n nie przekracza pojemnoci, jest uywany ponownie
+     * bez alokacji; zawarto jest wtedy nieokrelona.
      * @param n Rozmiar macierzy.
      * @return Referencja do obiektu matrix.
      */
     matrix& alokuj(int n);
 
+    /**
+     * @brief Zmienia rozmiar macierzy na n x n, opcjonalnie zachowujc zawarto.
+     * @param n Nowy rozmiar macierzy.
+     * @param zachowaj true aby zachowa wsplny lewy grny fragment (nowe elementy s zerowane).
+     * @return Referencja do obiektu matrix.
+     */
+    matrix& alokuj(int n, bool zachowaj);
+
+    /**
+     * @brief Zwraca pojemno bufora.
+     * @return Najwikszy rozmiar n, dla ktrego alokuj nie alokuje pamici.
+     */
+    int pojemnosc(void) const;
+
+    /**
+     * @brief Zwalnia nadmiarow pojemno, przenoszc zawarto do bufora o rozmiarze dokadnie n x n.
+     * @return Referencja do obiektu matrix.
+     */
+    matrix& dopasuj_pojemnosc(void);
+
+    /**
+     * @brief Zwraca sposb, w jaki przydzielono bufor macierzy (sterta, mapowanie, due strony).
+     * @return Sposb przydziau; PRZYDZIAL_STERTA dla macierzy bez bufora.
+     */
+    sposob_przydzialu przydzial(void) const;
+
     /**
      * @brief Wstawia warto do macierzy w okrelonej pozycji.
      * @param x Wiersz.
@@ -56,7 +156,12 @@ public:
      * @param wartosc Warto do wstawienia.
      * @return Referencja do obiektu matrix.
      */
-    matrix& wstaw(int x, int y, int wartosc);
+    matrix& wstaw(int x, int y, int wartosc)
+    {
+        odlacz();
+        mac[x][y] = wartosc;
+        return *this;
+    }
 
     /**
      * @brief Zwraca warto z macierzy z okrelonej pozycji.
@@ -64,7 +169,10 @@ public:
      * @param y Kolumna.
      * @return Warto z macierzy.
      */
-    int pokaz(int x, int y);
+    int pokaz(int x, int y) const
+    {
+        return mac[x][y];
+    }
 
     /**
      * @brief Odwraca macierz (transpozycja).
@@ -116,6 +224,57 @@ public:
      */
     matrix& wiersz(int y, int* t);
 
+    /**
+     * @brief Ustawia wartoci w wierszu macierzy z bufora o znanej dugoci.
+     * @param y Numer wiersza.
+     * @param t Bufor n wartoci.
+     * @return Referencja do obiektu matrix.
+     */
+    matrix& wiersz(int y, span<const int> t);
+
+    /**
+     * @brief Ustawia wartoci w kolumnie macierzy z bufora o znanej dugoci.
+     * @param x Numer kolumny.
+     * @param t Bufor n wartoci.
+     * @return Referencja do obiektu matrix.
+     */
+    matrix& kolumna(int x, span<const int> t);
+
+    /**
+     * @brief Ustawia prostoktny blok macierzy z bufora zapisanego wierszami.
+     * @param x Pierwszy wiersz bloku.
+     * @param y Pierwsza kolumna bloku.
+     * @param wys Liczba wierszy bloku.
+     * @param szer Liczba kolumn bloku.
+     * @param t Bufor wys * szer wartoci.
+     * @return Referencja do obiektu matrix.
+     */
+    matrix& blok(int x, int y, int wys, int szer, span<const int> t);
+
+    /**
+     * @brief Kopiuje wiersz macierzy do bufora.
+     * @param y Numer wiersza.
+     * @param t Bufor na n wartoci.
+     */
+    void pobierz_wiersz(int y, span<int> t) const;
+
+    /**
+     * @brief Kopiuje kolumn macierzy do bufora.
+     * @param x Numer kolumny.
+     * @param t Bufor na n wartoci.
+     */
+    void pobierz_kolumne(int x, span<int> t) const;
+
+    /**
+     * @brief Kopiuje prostoktny blok macierzy do bufora (wierszami).
+     * @param x Pierwszy wiersz bloku.
+     * @param y Pierwsza kolumna bloku.
+     * @param wys Liczba wierszy bloku.
+     * @param szer Liczba kolumn bloku.
+     * @param t Bufor na wys * szer wartoci.
+     */
+    void pobierz_blok(int x, int y, int wys, int szer, span<int> t) const;
+
     /**
      * @brief Ustawia wartoci na przektnej macierzy na 1, a pozostae na 0.
      * @return Referencja do obiektu matrix.
@@ -155,28 +314,293 @@ public:
     matrix& operator*(matrix& m);
 
     /**
-     * @brief Operator dodawania liczby do macierzy.
+     * @brief Operator odejmowania macierzy (element po elemencie, z zawijaniem modulo 2^32).
+     * @param m Macierz do odjcia.
+     * @return Referencja do obiektu matrix.
+     */
+    matrix& operator-(matrix& m);
+
+    /**
+     * @brief Mnoy macierz element po elemencie przez m (iloczyn Hadamarda, z zawijaniem modulo 2^32).
+     * @param m Macierz do pomnoenia.
+     * @return Referencja do obiektu matrix.
+     */
+    matrix& hadamard(matrix& m);
+
+    /**
+     * @brief Zastpuje kady element mniejszym z pary (this[i][j], m[i][j]).
+     * @param m Macierz do porwnania.
+     * @return Referencja do obiektu matrix.
+     */
+    matrix& minimum_elementow(matrix& m);
+
+    /**
+     * @brief Zastpuje kady element wikszym z pary (this[i][j], m[i][j]).
+     * @param m Macierz do porwnania.
+     * @return Referencja do obiektu matrix.
+     */
+    matrix& maksimum_elementow(matrix& m);
+
+    /**
+     * @brief Zapisuje w macierzy iloczyn Kroneckera a (x) b o rozmiarze (na * nb) x (na * nb).
+     * Rozmiar jest ustawiany przez alokuj, wic bufor o wystarczajcej pojemnoci jest uywany ponownie.
+     * @param a Lewy czynnik.
+     * @param b Prawy czynnik.
+     * @return Referencja do obiektu matrix.
+     */
+    matrix& iloczyn_kroneckera(matrix& a, matrix& b);
+
+    /**
+     * @brief Zapisuje w macierzy iloczyn zewntrzny x * y^T (z zawijaniem modulo 2^32).
+     * @param x Wektor n wartoci (kolumna).
+     * @param y Wektor n wartoci (wiersz).
+     * @return Referencja do obiektu matrix.
+     */
+    matrix& iloczyn_zewnetrzny(span<const int> x, span<const int> y);
+
+    /**
+     * @brief Podnosi macierz do potgi k metod szybkiego potgowania (przez podnoszenie do kwadratu).
+     * @param k Wykadnik (k >= 0).
+     * @return Referencja do obiektu matrix.
+     */
+    matrix& potega(int k);
+
+    /**
+     * @brief Podnosi macierz do potgi k modulo modul metod szybkiego potgowania.
+     * @param k Wykadnik (k >= 0).
+     * @param modul Modu arytmetyki chronicy przed przepenieniem int (0 - bez redukcji modulo).
+     * @return Referencja do obiektu matrix.
+     */
+    matrix& potega(int k, int modul);
+
+    /**
+     * @brief Mnoenie z epilogiem w jednym przebiegu: this = alfa * a * b + beta * this + przesuniecie.
+     * @param a Lewy czynnik iloczynu.
+     * @param b Prawy czynnik iloczynu.
+     * @param alfa Mnonik iloczynu a * b.
+     * @param beta Mnonik dotychczasowej zawartoci macierzy.
+     * @param przesuniecie Liczba dodawana do kadego elementu wyniku.
+     * @return Referencja do obiektu matrix.
+     */
+    matrix& gemm(matrix& a, matrix& b, int alfa, int beta, int przesuniecie);
+
+    /**
+     * @brief Mnoy macierz przez wektor: y = this * x.
+     * Arytmetyka zawija modulo 2^32.
+     * @param x Wektor n wartoci.
+     * @param y Bufor na n wartoci wyniku (nie moe pokrywa si z x).
+     */
+    void mnoz_wektor(span<const int> x, span<int> y) const;
+
+    /**
+     * @brief Mnoy wektor wierszowy przez macierz: y^T = x^T * this.
+     * Arytmetyka zawija modulo 2^32.
+     * @param x Wektor n wartoci.
+     * @param y Bufor na n wartoci wyniku (nie moe pokrywa si z x).
+     */
+    void mnoz_wektor_z_lewej(span<const int> x, span<int> y) const;
+
+    /**
+     * @brief Mnoy macierz przez k wektorw naraz: Y = this * X, gdzie X i Y maj n x k elementw.
+     * Przeznaczone dla maego k; kady element macierzy jest czytany raz dla wszystkich wektorw.
+     * Arytmetyka zawija modulo 2^32.
+     * @param x Macierz X (n x k, wierszami).
+     * @param k Liczba wektorw.
+     * @param y Bufor na macierz Y (n x k, wierszami; nie moe pokrywa si z x).
+     */
+    void mnoz_wektory(span<const int> x, int k, span<int> y) const;
+
+    /**
+     * @brief Dodaje macierz m z wybran polityk arytmetyki.
+     * @tparam P Polityka arytmetyki (zawijanie, nasycanie lub sprawdzanie).
+     * @param m Macierz do dodania.
+     * @return Referencja do obiektu matrix.
+     */
+    template <class P>
+    matrix& dodaj(matrix& m);
+
+    /**
+     * @brief Mnoy macierz przez macierz m z wybran polityk arytmetyki.
+     * @tparam P Polityka arytmetyki (zawijanie, nasycanie lub sprawdzanie).
+     * @param m Macierz do pomnoenia.
+     * @return Referencja do obiektu matrix.
+     */
+    template <class P>
+    matrix& mnoz(matrix& m);
+
+    /**
+     * @brief Mnoy macierz przez liczb z wybran polityk arytmetyki.
+     * @tparam P Polityka arytmetyki (zawijanie, nasycanie lub sprawdzanie).
+     * @param a Liczba do pomnoenia.
+     * @return Referencja do obiektu matrix.
+     */
+    template <class P>
+    matrix& mnoz(int a);
+
+    /**
+     * @brief Dodaje liczb do kadego elementu z wybran polityk arytmetyki.
+     * @tparam P Polityka arytmetyki (zawijanie, nasycanie lub sprawdzanie).
+     * @param a Liczba do dodania.
+     * @return Referencja do obiektu matrix.
+     */
+    template <class P>
+    matrix& dodaj(int a);
+
+    /**
+     * @brief Zwraca informacj o przepenieniu w ostatniej operacji z polityk sprawdzanie.
+     * @return true jeli wystpio przepenienie, false w przeciwnym razie.
+     */
+    bool przepelnienie(void);
+
+    /**
+     * @brief Oblicza iloczyn this * m z akumulacj i wynikiem 64-bitowym.
+     * Wynik jest dokadny, dopki |suma| < 2^63; poza tym zakresem jest nasycany do LLONG_MIN lub LLONG_MAX.
+     * @param m Macierz do pomnoenia.
+     * @param wynik Tablica n * n liczb long long na wynik (wierszami).
+     */
+    void iloczyn_szeroki(matrix& m, long long* wynik);
+
+    /**
+     * @brief Zwraca sum wszystkich elementw macierzy.
+     * @return Suma elementw w akumulatorze 64-bitowym.
+     */
+    long long suma(void);
+
+    /**
+     * @brief Zwraca najmniejszy element macierzy.
+     * @return Najmniejsza warto.
+     */
+    int minimum(void);
+
+    /**
+     * @brief Zwraca najwikszy element macierzy.
+     * @return Najwiksza warto.
+     */
+    int maksimum(void);
+
+    /**
+     * @brief Wyznacza pozycj najmniejszego elementu (pierwszego w kolejnoci wierszy).
+     * @param x Wiersz znalezionego elementu.
+     * @param y Kolumna znalezionego elementu.
+     * @return Najmniejsza warto.
+     */
+    int argmin(int& x, int& y);
+
+    /**
+     * @brief Wyznacza pozycj najwikszego elementu (pierwszego w kolejnoci wierszy).
+     * @param x Wiersz znalezionego elementu.
+     * @param y Kolumna znalezionego elementu.
+     * @return Najwiksza warto.
+     */
+    int argmax(int& x, int& y);
+
+    /**
+     * @brief Zwraca lad macierzy (sum elementw na przektnej).
+     * @return lad macierzy.
+     */
+    long long slad(void);
+
+    /**
+     * @brief Zwraca norm Frobeniusa macierzy.
+     * @return Pierwiastek z sumy kwadratw elementw.
+     */
+    double norma_frobeniusa(void);
+
+    /**
+     * @brief Zwraca norm L1 macierzy (najwiksz sum moduw w kolumnie).
+     * @return Norma L1.
+     */
+    long long norma_1(void);
+
+    /**
+     * @brief Zwraca norm L-nieskoczono macierzy (najwiksz sum moduw w wierszu).
+     * @return Norma L-nieskoczono.
+     */
+    long long norma_inf(void);
+
+    /**
+     * @brief Oblicza sumy wszystkich wierszy.
+     * @param t Tablica n liczb na wyniki.
+     */
+    void sumy_wierszy(long long* t);
+
+    /**
+     * @brief Oblicza sumy wszystkich kolumn.
+     * @param t Tablica n liczb na wyniki.
+     */
+    void sumy_kolumn(long long* t);
+
+    /**
+     * @brief Eliminacja Bareissa bez uamkw w liczbach 64-bitowych.
+     * Wszystkie elementy porednie s minorami macierzy, wic dzielenia s dokadne;
+     * przerywa, gdy iloczyn poredni przekroczyby 2^62.
+     * @param wyznacznik Wynik: wyznacznik macierzy.
+     * @return Rzd macierzy lub -1 przy przepenieniu.
+     */
+    int bareiss(long long& wyznacznik) const;
+
+    /**
+     * @brief Zwraca wyznacznik macierzy modulo liczba pierwsza.
+     * @param p Liczba pierwsza mniejsza od 2^31.
+     * @return Wyznacznik modulo p z przedziau [0, p).
+     */
+    unsigned int wyznacznik_modulo(unsigned int p) const;
+
+    /**
+     * @brief Zwraca rzd macierzy nad ciaem Z_p.
+     * @param p Liczba pierwsza mniejsza od 2^31.
+     * @return Rzd modulo p (nie wikszy ni rzd nad liczbami wymiernymi).
+     */
+    int rzad_modulo(unsigned int p) const;
+
+    /**
+     * @brief Zwraca dokadny wyznacznik w zapisie dziesitnym.
+     * Gdy eliminacja Bareissa si przepeni, wyznacznik jest liczony modulo tylu liczb pierwszych
+     * bliskich 2^31, by ich iloczyn przekroczy podwojone ograniczenie Hadamarda, rwnolegle
+     * dla rnych liczb pierwszych, i odtwarzany z chiskiego twierdzenia o resztach.
+     * @return Wyznacznik (dowolnej dugoci).
+     */
+    string wyznacznik(void) const;
+
+    /**
+     * @brief Zwraca dokadny rzd macierzy nad liczbami wymiernymi.
+     * Przy przepenieniu eliminacji Bareissa jest to najwikszy rzd modulo liczb pierwszych,
+     * ktrych iloczyn przekracza ograniczenie Hadamarda dowolnego niezerowego minora.
+     * @return Rzd macierzy.
+     */
+    int rzad(void) const;
+
+    /**
+     * @brief Sprawdza, czy wyznacznik macierzy jest rny od zera.
+     * Zwykle wystarcza jedna eliminacja modulo liczba pierwsza; pene sprawdzenie jest
+     * potrzebne tylko wtedy, gdy wyznacznik wyjdzie podzielny przez t liczb.
+     * @return true jeli macierz jest odwracalna nad liczbami wymiernymi.
+     */
+    bool odwracalna(void) const;
+
+    /**
+     * @brief Operator dodawania liczby do macierzy (z zawijaniem modulo 2^32).
      * @param a Liczba do dodania.
      * @return Referencja do obiektu matrix.
      */
     matrix& operator+(int a);
 
     /**
-     * @brief Operator mnoenia macierzy przez liczb.
+     * @brief Operator mnoenia macierzy przez liczb (z zawijaniem modulo 2^32).
      * @param a Liczba do pomnoenia.
      * @return Referencja do obiektu matrix.
      */
     matrix& operator*(int a);
 
     /**
-     * @brief Operator odejmowania liczby od macierzy.
+     * @brief Operator odejmowania liczby od macierzy (z zawijaniem modulo 2^32).
      * @param a Liczba do odjcia.
      * @return Referencja do obiektu matrix.
      */
     matrix& operator-(int a);
 
     /**
-     * @brief Operator dodawania liczby do macierzy (globalny).
+     * @brief Operator dodawania liczby do macierzy (globalny, z zawijaniem modulo 2^32).
      * @param a Liczba do dodania.
      * @param m Macierz.
      * @return Nowa macierz bdca wynikiem dodawania.
@@ -184,7 +608,7 @@ public:
     friend matrix operator+(int a, matrix& m);
 
     /**
-     * @brief Operator mnoenia liczby przez macierz (globalny).
+     * @brief Operator mnoenia liczby przez macierz (globalny, z zawijaniem modulo 2^32).
      * @param a Liczba do pomnoenia.
      * @param m Macierz.
      * @return Nowa macierz bdca wynikiem mnoenia.
@@ -192,7 +616,7 @@ public:
     friend matrix operator*(int a, matrix& m);
 
     /**
-     * @brief Operator odejmowania liczby od macierzy (globalny).
+     * @brief Operator odejmowania liczby od macierzy (globalny, z zawijaniem modulo 2^32).
      * @param a Liczba do odjcia.
      * @param m Macierz.
      * @return Nowa macierz bdca wynikiem odejmowania.
@@ -200,33 +624,33 @@ public:
     friend matrix operator-(int a, matrix& m);
 
     /**
-     * @brief Operator inkrementacji macierzy.
+     * @brief Operator inkrementacji macierzy (z zawijaniem modulo 2^32).
      * @return Referencja do obiektu matrix.
      */
     matrix& operator++(int);
 
     /**
-     * @brief Operator dekrementacji macierzy.
+     * @brief Operator dekrementacji macierzy (z zawijaniem modulo 2^32).
      * @return Referencja do obiektu matrix.
      */
     matrix& operator--(int);
 
     /**
-     * @brief Operator dodawania liczby do macierzy.
+     * @brief Operator dodawania liczby do macierzy (z zawijaniem modulo 2^32).
      * @param a Liczba do dodania.
      * @return Referencja do obiektu matrix.
      */
     matrix& operator+=(int a);
 
     /**
-     * @brief Operator odejmowania liczby od macierzy.
+     * @brief Operator odejmowania liczby od macierzy (z zawijaniem modulo 2^32).
      * @param a Liczba do odjcia.
      * @return Referencja do obiektu matrix.
      */
     matrix& operator-=(int a);
 
     /**
-     * @brief Operator mnoenia macierzy przez liczb.
+     * @brief Operator mnoenia macierzy przez liczb (z zawijaniem modulo 2^32).
      * @param a Liczba do pomnoenia.
      * @return Referencja do obiektu matrix.
      */
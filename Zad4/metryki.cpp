@@ -0,0 +1,389 @@
+#include "metryki.h"
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <mutex>
+#include <vector>
+using namespace std;
+
+/**
+ * @struct zdarzenie_sladu
+ * @brief Jedno wywołanie operacji zapisane do śladu.
+ */
+struct zdarzenie_sladu {
+    operacja op; ///< Operacja.
+    long long poczatek; ///< Czas rozpoczęcia w nanosekundach.
+    long long czas; ///< Czas trwania w nanosekundach.
+    int watek; ///< Numer wątku.
+};
+
+/**
+ * @struct liczniki_operacji
+ * @brief Liczniki jednej operacji w jednym wątku.
+ * Zapisuje je tylko wątek-właściciel, więc wystarczają operacje atomowe bez porządkowania,
+ * które pozwalają na odczyt z innego wątku w trakcie pracy.
+ */
+struct liczniki_operacji {
+    atomic<long long> wywolania{ 0 }; ///< Liczba wywołań.
+    atomic<long long> bajty{ 0 }; ///< Bajty odczytane i zapisane.
+    atomic<long long> przydzialy{ 0 }; ///< Liczba przydziałów.
+    atomic<long long> bajty_przydzialow{ 0 }; ///< Rozmiar przydziałów.
+    atomic<long long> czas_ns{ 0 }; ///< Łączny czas.
+    atomic<long long> histogram[KOSZYKI_CZASU] = {}; ///< Koszyki czasu.
+};
+
+/**
+ * @brief Zwiększa licznik zapisywany tylko przez jeden wątek.
+ * @param l Licznik.
+ * @param x Przyrost.
+ */
+static inline void zwieksz(atomic<long long>& l, long long x)
+{
+    l.store(l.load(memory_order_relaxed) + x, memory_order_relaxed);
+}
+
+struct metryki_watku;
+
+/**
+ * @struct rejestr_metryk
+ * @brief Lista wątków z licznikami i sumy wątków, które już się zakończyły.
+ */
+struct rejestr_metryk {
+    mutex blokada; ///< Chroni wszystkie pola.
+    vector<metryki_watku*> watki; ///< Żyjące wątki.
+    statystyki_operacji zakonczone[LICZBA_OPERACJI] = {}; ///< Sumy zakończonych wątków.
+    vector<zdarzenie_sladu> slad_zakonczonych; ///< Zdarzenia zakończonych wątków.
+    int nastepny_numer = 1; ///< Numer przydzielany kolejnemu wątkowi.
+};
+
+/**
+ * @brief Zwraca rejestr metryk.
+ * Rejestr nie jest nigdy zwalniany, bo wątki puli mogą kończyć się już po destrukcji obiektów statycznych.
+ * @return Rejestr.
+ */
+static rejestr_metryk& rejestr(void)
+{
+    static rejestr_metryk* r = new rejestr_metryk;
+    return *r;
+}
+
+/**
+ * @brief Czy pomiary mają zapisywać zdarzenia śladu.
+ */
+static atomic<bool> slad_wlaczony(false);
+
+/**
+ * @brief Chwila odniesienia dla znaczników czasu śladu.
+ */
+static const long long poczatek_programu = czas_ns();
+
+/**
+ * @brief Dodaje liczniki wątku do struktury statystyk.
+ * @param l Liczniki wątku.
+ * @param s Statystyki, do których dodawane są wartości.
+ */
+static void dodaj_liczniki(const liczniki_operacji& l, statystyki_operacji& s)
+{
+    s.wywolania += l.wywolania.load(memory_order_relaxed);
+    s.bajty += l.bajty.load(memory_order_relaxed);
+    s.przydzialy += l.przydzialy.load(memory_order_relaxed);
+    s.bajty_przydzialow += l.bajty_przydzialow.load(memory_order_relaxed);
+    s.czas_ns += l.czas_ns.load(memory_order_relaxed);
+    for (int k = 0; k < KOSZYKI_CZASU; k++)
+    {
+        s.histogram[k] += l.histogram[k].load(memory_order_relaxed);
+    }
+}
+
+/**
+ * @struct metryki_watku
+ * @brief Liczniki jednego wątku; rejestrują się przy pierwszym użyciu i przekazują sumy przy zakończeniu wątku.
+ */
+struct metryki_watku {
+    liczniki_operacji liczniki[LICZBA_OPERACJI]; ///< Liczniki operacji.
+    operacja biezaca = OP_INNE; ///< Operacja, której przypisywane są przydziały.
+    mutex blokada_sladu; ///< Chroni zdarzenia śladu przed odczytem z innego wątku.
+    vector<zdarzenie_sladu> slad; ///< Zdarzenia śladu.
+    int numer; ///< Numer wątku w śladzie.
+
+    metryki_watku(void)
+    {
+        rejestr_metryk& r = rejestr();
+        lock_guard<mutex> l(r.blokada);
+        numer = r.nastepny_numer++;
+        r.watki.push_back(this);
+    }
+
+    ~metryki_watku(void)
+    {
+        rejestr_metryk& r = rejestr();
+        lock_guard<mutex> l(r.blokada);
+        for (int i = 0; i < LICZBA_OPERACJI; i++)
+        {
+            dodaj_liczniki(liczniki[i], r.zakonczone[i]);
+        }
+        r.slad_zakonczonych.insert(r.slad_zakonczonych.end(), slad.begin(), slad.end());
+        for (size_t i = 0; i < r.watki.size(); i++)
+        {
+            if (r.watki[i] == this)
+            {
+                r.watki.erase(r.watki.begin() + i);
+                break;
+            }
+        }
+    }
+};
+
+/**
+ * @brief Zwraca liczniki bieżącego wątku.
+ * @return Liczniki wątku.
+ */
+static metryki_watku& lokalne(void)
+{
+    static thread_local metryki_watku m;
+    return m;
+}
+
+/**
+ * @brief Zwraca nazwę operacji używaną w eksporcie.
+ * @param op Operacja.
+ * @return Nazwa operacji.
+ */
+const char* nazwa_operacji(operacja op)
+{
+    static const char* nazwy[LICZBA_OPERACJI] = { "alokuj", "dowroc", "losuj", "dodawanie", "mnozenie", "potega", "gemm", "gemv", "elementowe", "zewnetrzne", "splot", "sumy", "eliminacja", "kompresja", "skalar", "wspolna", "inne" };
+    return op >= 0 && op < LICZBA_OPERACJI ? nazwy[op] : "?";
+}
+
+/**
+ * @brief Zwraca bieżący czas monotoniczny w nanosekundach.
+ * @return Czas w nanosekundach.
+ */
+long long czas_ns(void)
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Ustawia operację, której przypisywane są przydziały bieżącego wątku.
+ * @param op Nowa operacja.
+ * @return Poprzednia operacja.
+ */
+operacja ustaw_biezaca_operacje(operacja op)
+{
+    metryki_watku& m = lokalne();
+    operacja poprzednia = m.biezaca;
+    m.biezaca = op;
+    return poprzednia;
+}
+
+/**
+ * @brief Zapisuje jedno wywołanie operacji w licznikach bieżącego wątku.
+ * @param op Operacja.
+ * @param bajty Szacowana liczba bajtów odczytanych i zapisanych.
+ * @param poczatek Czas rozpoczęcia w nanosekundach.
+ * @param koniec Czas zakończenia w nanosekundach.
+ */
+void zapisz_pomiar(operacja op, long long bajty, long long poczatek, long long koniec)
+{
+    metryki_watku& m = lokalne();
+    liczniki_operacji& l = m.liczniki[op];
+    long long czas = koniec - poczatek;
+    int k = (int)bit_width((unsigned long long)(czas > 0 ? czas : 0));
+    zwieksz(l.wywolania, 1);
+    zwieksz(l.bajty, bajty);
+    zwieksz(l.czas_ns, czas);
+    zwieksz(l.histogram[k < KOSZYKI_CZASU ? k : KOSZYKI_CZASU - 1], 1);
+    if (slad_wlaczony.load(memory_order_relaxed))
+    {
+        lock_guard<mutex> b(m.blokada_sladu);
+        m.slad.push_back({ op, poczatek, czas, m.numer });
+    }
+}
+
+/**
+ * @brief Zapisuje przydział bufora w bieżącej operacji wątku.
+ * @param bajty Rozmiar przydziału.
+ */
+void zapisz_przydzial(long long bajty)
+{
+    metryki_watku& m = lokalne();
+    liczniki_operacji& l = m.liczniki[m.biezaca];
+    zwieksz(l.przydzialy, 1);
+    zwieksz(l.bajty_przydzialow, bajty);
+}
+
+/**
+ * @brief Sumuje metryki ze wszystkich wątków (także zakończonych).
+ * @param wynik Tablica LICZBA_OPERACJI struktur na wynik.
+ */
+void pobierz_metryki(statystyki_operacji* wynik)
+{
+    rejestr_metryk& r = rejestr();
+    lock_guard<mutex> l(r.blokada);
+    for (int i = 0; i < LICZBA_OPERACJI; i++)
+    {
+        wynik[i] = r.zakonczone[i];
+        for (metryki_watku* m : r.watki)
+        {
+            dodaj_liczniki(m->liczniki[i], wynik[i]);
+        }
+    }
+}
+
+/**
+ * @brief Zeruje metryki wszystkich wątków i usuwa zebrane zdarzenia śladu.
+ * Wywołanie równoległe z mierzonymi operacjami może zgubić pojedyncze przyrosty.
+ */
+void zeruj_metryki(void)
+{
+    rejestr_metryk& r = rejestr();
+    lock_guard<mutex> l(r.blokada);
+    for (int i = 0; i < LICZBA_OPERACJI; i++)
+    {
+        r.zakonczone[i] = statystyki_operacji{};
+        for (metryki_watku* m : r.watki)
+        {
+            liczniki_operacji& c = m->liczniki[i];
+            c.wywolania = 0;
+            c.bajty = 0;
+            c.przydzialy = 0;
+            c.bajty_przydzialow = 0;
+            c.czas_ns = 0;
+            for (int k = 0; k < KOSZYKI_CZASU; k++)
+            {
+                c.histogram[k] = 0;
+            }
+        }
+    }
+    r.slad_zakonczonych.clear();
+    for (metryki_watku* m : r.watki)
+    {
+        lock_guard<mutex> b(m->blokada_sladu);
+        m->slad.clear();
+    }
+}
+
+/**
+ * @brief Zapisuje metryki w formacie JSON.
+ * Element k tablicy "histogram" to liczba wywołań trwających od 2^(k-1) do 2^k ns
+ * (ostatni koszyk obejmuje też dłuższe wywołania).
+ * @param o Strumień wyjściowy.
+ */
+void eksportuj_json(ostream& o)
+{
+    statystyki_operacji s[LICZBA_OPERACJI];
+    pobierz_metryki(s);
+    o << "{\"operacje\":[";
+    for (int i = 0; i < LICZBA_OPERACJI; i++)
+    {
+        o << (i ? "," : "") << "{\"nazwa\":\"" << nazwa_operacji((operacja)i) << "\""
+            << ",\"wywolania\":" << s[i].wywolania
+            << ",\"bajty\":" << s[i].bajty
+            << ",\"przydzialy\":" << s[i].przydzialy
+            << ",\"bajty_przydzialow\":" << s[i].bajty_przydzialow
+            << ",\"czas_ns\":" << s[i].czas_ns
+            << ",\"histogram\":[";
+        for (int k = 0; k < KOSZYKI_CZASU; k++)
+        {
+            o << (k ? "," : "") << s[i].histogram[k];
+        }
+        o << "]}";
+    }
+    o << "]}" << endl;
+}
+
+/**
+ * @brief Zapisuje jeden licznik wszystkich operacji w formacie Prometheusa.
+ * @param o Strumień wyjściowy.
+ * @param s Statystyki operacji.
+ * @param nazwa Nazwa metryki.
+ * @param opis Opis metryki.
+ * @param pole Wskaźnik na pole statystyk.
+ */
+static void licznik_prometheus(ostream& o, const statystyki_operacji* s, const char* nazwa, const char* opis, long long statystyki_operacji::* pole)
+{
+    o << "# HELP " << nazwa << " " << opis << "\n# TYPE " << nazwa << " counter\n";
+    for (int i = 0; i < LICZBA_OPERACJI; i++)
+    {
+        o << nazwa << "{operacja=\"" << nazwa_operacji((operacja)i) << "\"} " << s[i].*pole << "\n";
+    }
+}
+
+/**
+ * @brief Zapisuje metryki w formacie tekstowym Prometheusa.
+ * @param o Strumień wyjściowy.
+ */
+void eksportuj_prometheus(ostream& o)
+{
+    statystyki_operacji s[LICZBA_OPERACJI];
+    pobierz_metryki(s);
+    licznik_prometheus(o, s, "matrix_wywolania_total", "Liczba wywolan operacji.", &statystyki_operacji::wywolania);
+    licznik_prometheus(o, s, "matrix_bajty_total", "Szacowana liczba bajtow odczytanych i zapisanych.", &statystyki_operacji::bajty);
+    licznik_prometheus(o, s, "matrix_przydzialy_total", "Liczba przydzialow buforow.", &statystyki_operacji::przydzialy);
+    licznik_prometheus(o, s, "matrix_bajty_przydzialow_total", "Laczny rozmiar przydzialow buforow.", &statystyki_operacji::bajty_przydzialow);
+    o << "# HELP matrix_czas_sekundy Czas wywolan operacji.\n# TYPE matrix_czas_sekundy histogram\n";
+    for (int i = 0; i < LICZBA_OPERACJI; i++)
+    {
+        const char* nazwa = nazwa_operacji((operacja)i);
+        long long narastajaco = 0;
+        for (int k = 0; k < KOSZYKI_CZASU - 1; k++)
+        {
+            narastajaco += s[i].histogram[k];
+            o << "matrix_czas_sekundy_bucket{operacja=\"" << nazwa << "\",le=\"" << (double)(1ULL << k) * 1e-9 << "\"} " << narastajaco << "\n";
+        }
+        o << "matrix_czas_sekundy_bucket{operacja=\"" << nazwa << "\",le=\"+Inf\"} " << s[i].wywolania << "\n";
+        o << "matrix_czas_sekundy_sum{operacja=\"" << nazwa << "\"} " << s[i].czas_ns * 1e-9 << "\n";
+        o << "matrix_czas_sekundy_count{operacja=\"" << nazwa << "\"} " << s[i].wywolania << "\n";
+    }
+}
+
+/**
+ * @brief Włącza lub wyłącza zbieranie zdarzeń śladu dla kolejnych pomiarów.
+ * @param wlacz Czy zbierać zdarzenia.
+ */
+void wlacz_slad(bool wlacz)
+{
+    slad_wlaczony.store(wlacz);
+}
+
+/**
+ * @brief Zapisuje jedno zdarzenie śladu jako zdarzenie typu "X" (zakres z czasem trwania).
+ * @param o Strumień wyjściowy.
+ * @param z Zdarzenie.
+ * @param pierwsze Czy to pierwsze zdarzenie w tablicy.
+ */
+static void zdarzenie_chrome(ostream& o, const zdarzenie_sladu& z, bool pierwsze)
+{
+    o << (pierwsze ? "" : ",\n") << "{\"name\":\"" << nazwa_operacji(z.op) << "\",\"cat\":\"matrix\",\"ph\":\"X\""
+        << ",\"ts\":" << (z.poczatek - poczatek_programu) / 1000 << "." << (z.poczatek - poczatek_programu) % 1000 / 100
+        << ",\"dur\":" << z.czas / 1000 << "." << z.czas % 1000 / 100
+        << ",\"pid\":1,\"tid\":" << z.watek << "}";
+}
+
+/**
+ * @brief Zapisuje zebrane zdarzenia w formacie śladu Chrome (chrome://tracing, Perfetto).
+ * @param o Strumień wyjściowy.
+ */
+void eksportuj_slad_chrome(ostream& o)
+{
+    rejestr_metryk& r = rejestr();
+    lock_guard<mutex> l(r.blokada);
+    bool pierwsze = true;
+    o << "{\"traceEvents\":[\n";
+    for (const zdarzenie_sladu& z : r.slad_zakonczonych)
+    {
+        zdarzenie_chrome(o, z, pierwsze);
+        pierwsze = false;
+    }
+    for (metryki_watku* m : r.watki)
+    {
+        lock_guard<mutex> b(m->blokada_sladu);
+        for (const zdarzenie_sladu& z : m->slad)
+        {
+            zdarzenie_chrome(o, z, pierwsze);
+            pierwsze = false;
+        }
+    }
+    o << "\n]}" << endl;
+}
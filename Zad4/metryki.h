@@ -0,0 +1,167 @@
+#pragma once
+#include <ostream>
+using namespace std;
+
+/**
+ * @file metryki.h
+ * @brief Liczniki i pomiary czasu operacji na macierzach.
+ *
+ * Pomiar wcza si, kompilujc z symbolem METRYKI (domylnie w konfiguracji Debug).
+ * Bez niego makra MIERZ_OPERACJE i MIERZ_PRZYDZIAL rozwijaj si do pustych instrukcji,
+ * wic kod produkcyjny nie ponosi adnego kosztu. Liczniki s trzymane w pamici
+ * lokalnej wtku i sumowane dopiero przy odczycie.
+ */
+
+/**
+ * @brief Operacje, dla ktrych zbierane s metryki.
+ */
+enum operacja {
+    OP_ALOKUJ,     ///< alokuj.
+    OP_DOWROC,     ///< dowroc.
+    OP_LOSUJ,      ///< losuj.
+    OP_DODAWANIE,  ///< Dodawanie macierzy (operator+, dodaj).
+    OP_MNOZENIE,   ///< Mnoenie macierzy (operator*, mnoz).
+    OP_POTEGA,     ///< potega.
+    OP_GEMM,       ///< gemm.
+    OP_GEMV,       ///< Mnoenie macierzy przez wektory.
+    OP_ELEMENTOWE, ///< Operacje element po elemencie (odejmowanie, Hadamard, minimum, maksimum).
+    OP_ZEWNETRZNE, ///< Iloczyny Kroneckera i zewntrzne.
+    OP_SPLOT,      ///< Splot dwuwymiarowy.
+    OP_SUMY,       ///< Budowa i aktualizacja tablic sum prefiksowych.
+    OP_ELIMINACJA, ///< Wyznacznik i rzd (eliminacja Bareissa i modularna).
+    OP_KOMPRESJA,  ///< Kompresja i rozpakowywanie macierzy skompresowanych.
+    OP_SKALAR,     ///< Operacje ze skalarem i operatory zoone.
+    OP_WSPOLNA,    ///< Publikowanie migawek macierzy wspdzielonych.
+    OP_INNE,       ///< Przydziay wykonane poza mierzonymi operacjami.
+    LICZBA_OPERACJI ///< Liczba rodzajw operacji.
+};
+
+/**
+ * @brief Liczba koszykw histogramu czasu; koszyk k obejmuje czasy z przedziau [2^(k-1), 2^k) ns.
+ */
+const int KOSZYKI_CZASU = 40;
+
+/**
+ * @struct statystyki_operacji
+ * @brief Zsumowane metryki jednej operacji ze wszystkich wtkw.
+ */
+struct statystyki_operacji {
+    long long wywolania; ///< Liczba wywoa.
+    long long bajty; ///< Szacowana liczba bajtw odczytanych i zapisanych.
+    long long przydzialy; ///< Liczba przydziaw buforw w trakcie operacji.
+    long long bajty_przydzialow; ///< czny rozmiar tych przydziaw.
+    long long czas_ns; ///< czny czas wywoa w nanosekundach.
+    long long histogram[KOSZYKI_CZASU]; ///< Liczba wywoa w kadym koszyku czasu.
+};
+
+/**
+ * @brief Zwraca nazw operacji uywan w eksporcie.
+ * @param op Operacja.
+ * @return Nazwa operacji.
+ */
+const char* nazwa_operacji(operacja op);
+
+/**
+ * @brief Zwraca biecy czas monotoniczny w nanosekundach.
+ * @return Czas w nanosekundach.
+ */
+long long czas_ns(void);
+
+/**
+ * @brief Ustawia operacj, ktrej przypisywane s przydziay biecego wtku.
+ * @param op Nowa operacja.
+ * @return Poprzednia operacja.
+ */
+operacja ustaw_biezaca_operacje(operacja op);
+
+/**
+ * @brief Zapisuje jedno wywoanie operacji w licznikach biecego wtku.
+ * @param op Operacja.
+ * @param bajty Szacowana liczba bajtw odczytanych i zapisanych.
+ * @param poczatek Czas rozpoczcia w nanosekundach.
+ * @param koniec Czas zakoczenia w nanosekundach.
+ */
+void zapisz_pomiar(operacja op, long long bajty, long long poczatek, long long koniec);
+
+/**
+ * @brief Zapisuje przydzia bufora w biecej operacji wtku.
+ * @param bajty Rozmiar przydziau.
+ */
+void zapisz_przydzial(long long bajty);
+
+/**
+ * @brief Sumuje metryki ze wszystkich wtkw (take zakoczonych).
+ * @param wynik Tablica LICZBA_OPERACJI struktur na wynik.
+ */
+void pobierz_metryki(statystyki_operacji* wynik);
+
+/**
+ * @brief Zeruje metryki wszystkich wtkw i usuwa zebrane zdarzenia ladu.
+ */
+void zeruj_metryki(void);
+
+/**
+ * @brief Zapisuje metryki w formacie JSON.
+ * @param o Strumie wyjciowy.
+ */
+void eksportuj_json(ostream& o);
+
+/**
+ * @brief Zapisuje metryki w formacie tekstowym Prometheusa.
+ * @param o Strumie wyjciowy.
+ */
+void eksportuj_prometheus(ostream& o);
+
+/**
+ * @brief Wcza lub wycza zbieranie zdarze ladu dla kolejnych pomiarw.
+ * @param wlacz Czy zbiera zdarzenia.
+ */
+void wlacz_slad(bool wlacz);
+
+/**
+ * @brief Zapisuje zebrane zdarzenia w formacie ladu Chrome (chrome://tracing, Perfetto).
+ * @param o Strumie wyjciowy.
+ */
+void eksportuj_slad_chrome(ostream& o);
+
+/**
+ * @class pomiar_operacji
+ * @brief Mierzy czas ycia zakresu i zapisuje go jako jedno wywoanie operacji.
+ */
+class pomiar_operacji {
+private:
+    operacja op; ///< Mierzona operacja.
+    operacja poprzednia; ///< Operacja przywracana po zakoczeniu pomiaru.
+    long long bajty; ///< Szacowana liczba bajtw odczytanych i zapisanych.
+    long long poczatek; ///< Czas rozpoczcia w nanosekundach.
+
+public:
+    /**
+     * @brief Rozpoczyna pomiar operacji.
+     * @param op Operacja.
+     * @param bajty Szacowana liczba bajtw odczytanych i zapisanych.
+     */
+    pomiar_operacji(operacja op, long long bajty) : op(op), poprzednia(ustaw_biezaca_operacje(op)), bajty(bajty), poczatek(czas_ns())
+    {
+    }
+
+    /**
+     * @brief Koczy pomiar i zapisuje go w licznikach wtku.
+     */
+    ~pomiar_operacji(void)
+    {
+        zapisz_pomiar(op, bajty, poczatek, czas_ns());
+        ustaw_biezaca_operacje(poprzednia);
+    }
+
+    pomiar_operacji(const pomiar_operacji&) = delete;
+    pomiar_operacji& operator=(const pomiar_operacji&) = delete;
+};
+
+#ifdef METRYKI
+#define MIERZ_OPERACJE(op, bajty) pomiar_operacji pomiar_zakresu((op), (long long)(bajty))
+#define MIERZ_PRZYDZIAL(bajty) zapisz_przydzial((long long)(bajty))
+#else
+#define MIERZ_OPERACJE(op, bajty) ((void)0)
+#define MIERZ_PRZYDZIAL(bajty) ((void)0)
+#endif
@@ -0,0 +1,415 @@
+#include "pamiec.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <dirent.h>
+#endif
+using namespace std;
+
+/**
+ * @brief Rozmiar nagłówka poprzedzającego dane bufora (zachowuje wyrównanie do linii pamięci podręcznej).
+ */
+static const size_t NAGLOWEK = 64;
+
+/**
+ * @struct naglowek_bufora
+ * @brief Informacje zapisane przed danymi bufora, potrzebne do jego zwolnienia.
+ */
+struct naglowek_bufora {
+    size_t bajty; ///< Rozmiar całego przydziału razem z nagłówkiem.
+    sposob_przydzialu sposob; ///< Sposób przydziału.
+};
+
+/**
+ * @brief Bieżąca polityka NUMA.
+ */
+static atomic<int> polityka(NUMA_BRAK);
+
+/**
+ * @brief Bieżący tryb dużych stron.
+ */
+static atomic<int> tryb_stron(DUZE_STRONY_THP);
+
+/**
+ * @brief Rozmiar przydziału, od którego używane są duże strony.
+ */
+static atomic<size_t> prog_stron(PROG_DUZYCH_STRON);
+
+/**
+ * @brief Liczba przydziałów każdego rodzaju od startu programu.
+ */
+static atomic<long long> licznik_przydzialow[LICZBA_SPOSOBOW_PRZYDZIALU];
+
+/**
+ * @brief Liczba bajtów obecnie przydzielonych każdym sposobem.
+ */
+static atomic<long long> licznik_bajtow[LICZBA_SPOSOBOW_PRZYDZIALU];
+
+/**
+ * @brief Liczba przydziałów, dla których duże strony były niedostępne.
+ */
+static atomic<long long> licznik_nieudanych(0);
+
+/**
+ * @brief Ustawia politykę NUMA dla kolejnych przydziałów.
+ * @param p Nowa polityka.
+ */
+void ustaw_polityke_numa(polityka_numa p)
+{
+    polityka.store(p);
+}
+
+/**
+ * @brief Zwraca bieżącą politykę NUMA.
+ * @return Polityka NUMA.
+ */
+polityka_numa aktualna_polityka_numa(void)
+{
+    return (polityka_numa)polityka.load();
+}
+
+/**
+ * @brief Odczytuje liczbę węzłów NUMA z systemu.
+ * @return Liczba węzłów (co najmniej 1).
+ */
+static int policz_wezly_numa(void)
+{
+    int n = 0;
+#ifdef _WIN32
+    ULONG najwyzszy = 0;
+    if (GetNumaHighestNodeNumber(&najwyzszy))
+    {
+        n = (int)najwyzszy + 1;
+    }
+#else
+    DIR* katalog = opendir("/sys/devices/system/node");
+    if (katalog != nullptr)
+    {
+        struct dirent* wpis;
+        while ((wpis = readdir(katalog)) != nullptr)
+        {
+            if (strncmp(wpis->d_name, "node", 4) == 0 && wpis->d_name[4] >= '0' && wpis->d_name[4] <= '9')
+            {
+                n++;
+            }
+        }
+        closedir(katalog);
+    }
+#endif
+    return n > 0 ? n : 1;
+}
+
+/**
+ * @brief Zwraca liczbę węzłów NUMA systemu.
+ * @return Liczba węzłów (co najmniej 1).
+ */
+int liczba_wezlow_numa(void)
+{
+    static int wezly = policz_wezly_numa();
+    return wezly;
+}
+
+/**
+ * @brief Ustawia tryb dużych stron dla kolejnych przydziałów.
+ * @param t Nowy tryb.
+ */
+void ustaw_duze_strony(tryb_duzych_stron t)
+{
+    tryb_stron.store(t);
+}
+
+/**
+ * @brief Zwraca bieżący tryb dużych stron.
+ * @return Tryb dużych stron.
+ */
+tryb_duzych_stron aktualne_duze_strony(void)
+{
+    return (tryb_duzych_stron)tryb_stron.load();
+}
+
+/**
+ * @brief Ustawia rozmiar przydziału, od którego używane są duże strony.
+ * @param bajty Próg w bajtach.
+ */
+void ustaw_prog_duzych_stron(size_t bajty)
+{
+    prog_stron.store(bajty);
+}
+
+/**
+ * @brief Rozkłada strony zmapowanego zakresu na przemian na wszystkie węzły NUMA.
+ * Musi być wywołane przed pierwszym zapisem do zakresu. Windows nie udostępnia
+ * przeplotu dla jednego zakresu, więc tam strony są rozmieszczane przez pierwszy zapis.
+ * @param p Początek zakresu (wyrównany do strony).
+ * @param bajty Rozmiar zakresu.
+ */
+static void przeplot(void* p, size_t bajty)
+{
+#if !defined(_WIN32) && defined(SYS_mbind)
+    const int MPOL_PRZEPLOT = 3;
+    int wezly = liczba_wezlow_numa();
+    if (wezly > 1)
+    {
+        unsigned long maska[16] = { 0 };
+        for (int w = 0; w < wezly && w < (int)(sizeof(maska) * 8); w++)
+        {
+            maska[w / (sizeof(unsigned long) * 8)] |= 1UL << (w % (sizeof(unsigned long) * 8));
+        }
+        syscall(SYS_mbind, p, bajty, MPOL_PRZEPLOT, maska, sizeof(maska) * 8, 0);
+    }
+#endif
+}
+
+/**
+ * @brief Mapuje strony bezpośrednio z systemu.
+ * @param bajty Rozmiar mapowania.
+ * @return Początek mapowania lub nullptr.
+ */
+static void* mapuj(size_t bajty)
+{
+#ifdef _WIN32
+    return VirtualAlloc(nullptr, bajty, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    void* p = mmap(nullptr, bajty, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? nullptr : p;
+#endif
+}
+
+/**
+ * @brief Sprawdza, czy jądro pozwala na przezroczyste duże strony.
+ * @return false jeśli THP są wyłączone ("never"), true w przeciwnym razie.
+ */
+static bool thp_dostepne(void)
+{
+#ifdef _WIN32
+    return false;
+#else
+    static bool dostepne = [] {
+        char tekst[128] = { 0 };
+        FILE* f = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+        if (f == nullptr)
+        {
+            return false;
+        }
+        size_t n = fread(tekst, 1, sizeof(tekst) - 1, f);
+        fclose(f);
+        tekst[n] = 0;
+        return strstr(tekst, "[never]") == nullptr;
+    }();
+    return dostepne;
+#endif
+}
+
+/**
+ * @brief Mapuje zakres wyrównany do dużych stron (2 MiB) w bieżącym trybie.
+ * Tryb DUZE_STRONY_HUGETLB próbuje najpierw jawnych stron hugetlbfs, a potem THP.
+ * @param bajty Żądany rozmiar; zwracany jest rozmiar zaokrąglony do dużych stron.
+ * @param sposob Sposób przydziału, który się powiódł.
+ * @return Początek mapowania lub nullptr, jeśli duże strony są niedostępne.
+ */
+static void* mapuj_duze(size_t& bajty, sposob_przydzialu& sposob)
+{
+#ifdef _WIN32
+    size_t duza = GetLargePageMinimum();
+    if (duza == 0)
+    {
+        return nullptr;
+    }
+    size_t dlugosc = (bajty + duza - 1) / duza * duza;
+    void* p = VirtualAlloc(nullptr, dlugosc, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+    if (p == nullptr)
+    {
+        return nullptr;
+    }
+    bajty = dlugosc;
+    sposob = PRZYDZIAL_HUGETLB;
+    return p;
+#else
+    const size_t duza = (size_t)2 << 20;
+    size_t dlugosc = (bajty + duza - 1) / duza * duza;
+#ifdef MAP_HUGETLB
+    if (aktualne_duze_strony() == DUZE_STRONY_HUGETLB)
+    {
+        void* p = mmap(nullptr, dlugosc, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+        {
+            bajty = dlugosc;
+            sposob = PRZYDZIAL_HUGETLB;
+            return p;
+        }
+    }
+#endif
+#ifdef MADV_HUGEPAGE
+    if (!thp_dostepne())
+    {
+        return nullptr;
+    }
+    char* p = (char*)mmap(nullptr, dlugosc + duza, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == (char*)MAP_FAILED)
+    {
+        return nullptr;
+    }
+    char* poczatek = (char*)(((size_t)p + duza - 1) / duza * duza);
+    if (poczatek > p)
+    {
+        munmap(p, poczatek - p);
+    }
+    if (p + duza > poczatek)
+    {
+        munmap(poczatek + dlugosc, p + duza - poczatek);
+    }
+    madvise(poczatek, dlugosc, MADV_HUGEPAGE);
+    bajty = dlugosc;
+    sposob = PRZYDZIAL_THP;
+    return poczatek;
+#else
+    return nullptr;
+#endif
+#endif
+}
+
+/**
+ * @brief Przydziela bufor na podaną liczbę elementów int zgodnie z polityką NUMA.
+ * Bufory od progu dużych stron są mapowane w zakresach wyrównanych do 2 MiB; gdy duże
+ * strony są niedostępne, przydział wraca do zwykłych stron. Strony bufora nie są
+ * dotykane (poza nagłówkiem), więc o ich położeniu decyduje pierwszy zapis lub
+ * polityka przeplotu.
+ * @param elementy Liczba elementów.
+ * @return Wskaźnik na bufor wyrównany do 64 bajtów.
+ */
+int* przydziel_bufor(size_t elementy)
+{
+    size_t bajty = NAGLOWEK + elementy * sizeof(int);
+    char* baza = nullptr;
+    sposob_przydzialu sposob = PRZYDZIAL_STERTA;
+    if (aktualne_duze_strony() != DUZE_STRONY_WYLACZONE && bajty >= prog_stron.load())
+    {
+        baza = (char*)mapuj_duze(bajty, sposob);
+        if (baza == nullptr)
+        {
+            licznik_nieudanych++;
+        }
+    }
+    if (baza == nullptr && aktualna_polityka_numa() == NUMA_PRZEPLOT)
+    {
+        baza = (char*)mapuj(bajty);
+        sposob = PRZYDZIAL_MAPOWANIE;
+    }
+    if (baza != nullptr && aktualna_polityka_numa() == NUMA_PRZEPLOT)
+    {
+        przeplot(baza, bajty);
+    }
+    if (baza == nullptr)
+    {
+        baza = (char*)::operator new(bajty, align_val_t(NAGLOWEK));
+        sposob = PRZYDZIAL_STERTA;
+    }
+    naglowek_bufora* n = (naglowek_bufora*)baza;
+    n->bajty = bajty;
+    n->sposob = sposob;
+    licznik_przydzialow[sposob]++;
+    licznik_bajtow[sposob] += bajty;
+    return (int*)(baza + NAGLOWEK);
+}
+
+/**
+ * @brief Zwraca rozmiar segmentu pamięci współdzielonej mieszczącego bufor razem z nagłówkiem.
+ * @param elementy Liczba elementów.
+ * @return Liczba bajtów segmentu.
+ */
+size_t bajty_bufora_wspolnego(size_t elementy)
+{
+    return NAGLOWEK + (elementy > 0 ? elementy : 1) * sizeof(int);
+}
+
+/**
+ * @brief Udostępnia bufor leżący w zmapowanym segmencie pamięci współdzielonej.
+ * Bufor zwalnia się przez zwolnij_bufor, które odmapowuje segment (sam segment trwa dalej).
+ * @param baza Początek mapowania segmentu.
+ * @param bajty Rozmiar mapowania.
+ * @param nowy true - zapisuje nagłówek w nowym segmencie; false - sprawdza nagłówek segmentu utworzonego przez inny proces.
+ * @return Wskaźnik na dane lub nullptr, gdy nagłówek jest niepoprawny.
+ */
+int* bufor_wspolny(void* baza, size_t bajty, bool nowy)
+{
+    naglowek_bufora* n = (naglowek_bufora*)baza;
+    if (nowy)
+    {
+        n->bajty = bajty;
+        n->sposob = PRZYDZIAL_WSPOLNY;
+    }
+    // Na Windows mapowanie jest zaokrąglone do strony, więc nagłówek może podawać mniej bajtów.
+    else if (bajty < NAGLOWEK || n->sposob != PRZYDZIAL_WSPOLNY || n->bajty > bajty || n->bajty < NAGLOWEK)
+    {
+        return nullptr;
+    }
+    licznik_przydzialow[PRZYDZIAL_WSPOLNY]++;
+    licznik_bajtow[PRZYDZIAL_WSPOLNY] += n->bajty;
+    return (int*)((char*)baza + NAGLOWEK);
+}
+
+/**
+ * @brief Zwraca sposób, w jaki przydzielono bufor.
+ * @param dane Wskaźnik zwrócony przez przydziel_bufor.
+ * @return Sposób przydziału.
+ */
+sposob_przydzialu sposob_bufora(const int* dane)
+{
+    return ((const naglowek_bufora*)((const char*)dane - NAGLOWEK))->sposob;
+}
+
+/**
+ * @brief Zwraca statystyki przydziałów według sposobu przydziału.
+ * @return Migawka liczników.
+ */
+statystyki_pamieci pobierz_statystyki_pamieci(void)
+{
+    statystyki_pamieci s;
+    for (int i = 0; i < LICZBA_SPOSOBOW_PRZYDZIALU; i++)
+    {
+        s.przydzialy[i] = licznik_przydzialow[i].load();
+        s.bajty[i] = licznik_bajtow[i].load();
+    }
+    s.nieudane_duze_strony = licznik_nieudanych.load();
+    return s;
+}
+
+/**
+ * @brief Zwalnia bufor przydzielony przez przydziel_bufor lub udostępniony przez bufor_wspolny.
+ * @param dane Wskaźnik zwrócony przez przydziel_bufor.
+ */
+void zwolnij_bufor(int* dane)
+{
+    if (dane == nullptr)
+    {
+        return;
+    }
+    char* baza = (char*)dane - NAGLOWEK;
+    naglowek_bufora* n = (naglowek_bufora*)baza;
+    licznik_bajtow[n->sposob] -= n->bajty;
+    if (n->sposob != PRZYDZIAL_STERTA)
+    {
+#ifdef _WIN32
+        if (n->sposob == PRZYDZIAL_WSPOLNY)
+        {
+            UnmapViewOfFile(baza);
+        }
+        else
+        {
+            VirtualFree(baza, 0, MEM_RELEASE);
+        }
+#else
+        munmap(baza, n->bajty);
+#endif
+        return;
+    }
+    ::operator delete(baza, align_val_t(NAGLOWEK));
+}
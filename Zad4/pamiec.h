@@ -0,0 +1,136 @@
+#pragma once
+#include <cstddef>
+using namespace std;
+
+/**
+ * @file pamiec.h
+ * @brief Przydzia buforw macierzy z uwzgldnieniem topologii NUMA i duych stron.
+ */
+
+/**
+ * @brief Domylny rozmiar przydziau (w bajtach), od ktrego uywane s due strony.
+ */
+const size_t PROG_DUZYCH_STRON = (size_t)4 << 20;
+
+/**
+ * @brief Polityka rozmieszczenia stron bufora midzy wzami NUMA.
+ */
+enum polityka_numa {
+    NUMA_BRAK,          ///< Strony trafiaj do wza wtku, ktry pierwszy je zapisze.
+    NUMA_PRZEPLOT,      ///< Strony rozkadane na przemian na wszystkie wzy.
+    NUMA_BLOKI_WIERSZY  ///< Kady blok wierszy dotykany najpierw przez wtek, ktry go pniej przetwarza.
+};
+
+/**
+ * @brief Tryb uycia duych stron (2 MiB) dla buforw od progu PROG_DUZYCH_STRON.
+ */
+enum tryb_duzych_stron {
+    DUZE_STRONY_WYLACZONE, ///< Zawsze zwyke strony.
+    DUZE_STRONY_THP,       ///< Przezroczyste due strony (madvise(MADV_HUGEPAGE)).
+    DUZE_STRONY_HUGETLB    ///< Jawne due strony (MAP_HUGETLB / MEM_LARGE_PAGES), a gdy ich brak - THP.
+};
+
+/**
+ * @brief Sposb, w jaki przydzielono bufor.
+ */
+enum sposob_przydzialu {
+    PRZYDZIAL_STERTA,    ///< Pami ze sterty (new).
+    PRZYDZIAL_MAPOWANIE, ///< Zwyke strony zmapowane bezporednio z systemu (mmap / VirtualAlloc).
+    PRZYDZIAL_THP,       ///< Zakres wyrwnany do 2 MiB z przezroczystymi duymi stronami.
+    PRZYDZIAL_HUGETLB,   ///< Jawne due strony.
+    PRZYDZIAL_WSPOLNY,   ///< Segment pamici wspdzielonej midzy procesami (wspolna.h).
+    LICZBA_SPOSOBOW_PRZYDZIALU ///< Liczba sposobw przydziau.
+};
+
+/**
+ * @struct statystyki_pamieci
+ * @brief Migawka licznikw przydziaw buforw macierzy.
+ */
+struct statystyki_pamieci {
+    long long przydzialy[LICZBA_SPOSOBOW_PRZYDZIALU]; ///< Liczba przydziaw kadym sposobem od startu programu.
+    long long bajty[LICZBA_SPOSOBOW_PRZYDZIALU]; ///< Bajty obecnie przydzielone kadym sposobem.
+    long long nieudane_duze_strony; ///< Przydziay, dla ktrych due strony byy niedostpne.
+};
+
+/**
+ * @brief Ustawia polityk NUMA dla kolejnych przydziaw.
+ * @param p Nowa polityka.
+ */
+void ustaw_polityke_numa(polityka_numa p);
+
+/**
+ * @brief Zwraca biec polityk NUMA.
+ * @return Polityka NUMA.
+ */
+polityka_numa aktualna_polityka_numa(void);
+
+/**
+ * @brief Zwraca liczb wzw NUMA systemu.
+ * @return Liczba wzw (co najmniej 1).
+ */
+int liczba_wezlow_numa(void);
+
+/**
+ * @brief Ustawia tryb duych stron dla kolejnych przydziaw.
+ * @param t Nowy tryb.
+ */
+void ustaw_duze_strony(tryb_duzych_stron t);
+
+/**
+ * @brief Zwraca biecy tryb duych stron.
+ * @return Tryb duych stron.
+ */
+tryb_duzych_stron aktualne_duze_strony(void);
+
+/**
+ * @brief Ustawia rozmiar przydziau, od ktrego uywane s due strony.
+ * @param bajty Prg w bajtach.
+ */
+void ustaw_prog_duzych_stron(size_t bajty);
+
+/**
+ * @brief Przydziela bufor na podan liczb elementw int zgodnie z polityk NUMA.
+ * Bufory od progu duych stron s mapowane w zakresach wyrwnanych do 2 MiB, a gdy
+ * due strony s niedostpne, przydzia wraca do zwykych stron. Strony bufora
+ * nie s dotykane (poza nagwkiem), wic o ich pooeniu decyduje pierwszy zapis
+ * lub polityka przeplotu.
+ * @param elementy Liczba elementw.
+ * @return Wskanik na bufor wyrwnany do 64 bajtw.
+ */
+int* przydziel_bufor(size_t elementy);
+
+/**
+ * @brief Zwalnia bufor przydzielony przez przydziel_bufor lub udostpniony przez bufor_wspolny.
+ * @param dane Wskanik zwrcony przez przydziel_bufor.
+ */
+void zwolnij_bufor(int* dane);
+
+/**
+ * @brief Zwraca rozmiar segmentu pamici wspdzielonej mieszczcego bufor razem z nagwkiem.
+ * @param elementy Liczba elementw.
+ * @return Liczba bajtw segmentu.
+ */
+size_t bajty_bufora_wspolnego(size_t elementy);
+
+/**
+ * @brief Udostpnia bufor lecy w zmapowanym segmencie pamici wspdzielonej.
+ * Bufor zwalnia si przez zwolnij_bufor, ktre odmapowuje segment (sam segment trwa dalej).
+ * @param baza Pocztek mapowania segmentu.
+ * @param bajty Rozmiar mapowania.
+ * @param nowy true - zapisuje nagwek w nowym segmencie; false - sprawdza nagwek segmentu utworzonego przez inny proces.
+ * @return Wskanik na dane lub nullptr, gdy nagwek jest niepoprawny.
+ */
+int* bufor_wspolny(void* baza, size_t bajty, bool nowy);
+
+/**
+ * @brief Zwraca sposb, w jaki przydzielono bufor.
+ * @param dane Wskanik zwrcony przez przydziel_bufor.
+ * @return Sposb przydziau.
+ */
+sposob_przydzialu sposob_bufora(const int* dane);
+
+/**
+ * @brief Zwraca statystyki przydziaw wedug sposobu przydziau.
+ * @return Migawka licznikw.
+ */
+statystyki_pamieci pobierz_statystyki_pamieci(void);
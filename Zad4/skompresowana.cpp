@@ -0,0 +1,617 @@
+#include "skompresowana.h"
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <utility>
+#include "watki.h"
+#include "metryki.h"
+using namespace std;
+
+/**
+ * @brief Liczba elementów bloku w jednym pasie.
+ */
+static const int ELEMENTY_PASA = ELEMENTY_BLOKU_KOMPRESJI / PASY_KOMPRESJI;
+
+/**
+ * @brief Rozpakowuje elementy (E * PASY_KOMPRESJI, ..., E * PASY_KOMPRESJI + PASY_KOMPRESJI - 1) bloku o B bitach.
+ * Przesunięcia są stałymi, więc pętla po pasach jest jedną operacją wektorową na ośmiu słowach.
+ * @param w Pierwsze słowo bloku.
+ * @param p Podstawa bloku.
+ * @param wyjscie Bufor na ELEMENTY_BLOKU_KOMPRESJI wartości.
+ */
+template<int B, int E>
+static inline void rozpakuj_krok(const unsigned int* w, unsigned int p, int* wyjscie)
+{
+    constexpr int bit = E * B;
+    constexpr int s = bit & 31;
+    constexpr unsigned int maska = (unsigned int)((1ull << B) - 1);
+    const unsigned int* a = w + (bit >> 5) * PASY_KOMPRESJI;
+    int* o = wyjscie + E * PASY_KOMPRESJI;
+    for (int l = 0; l < PASY_KOMPRESJI; l++)
+    {
+        if constexpr (s + B > 32)
+        {
+            o[l] = (int)(p + (((a[l] >> s) | (a[l + PASY_KOMPRESJI] << ((32 - s) & 31))) & maska));
+        }
+        else
+        {
+            o[l] = (int)(p + ((a[l] >> s) & maska));
+        }
+    }
+}
+
+/**
+ * @brief Rozpakowuje blok o B bitach na element, krok po kroku dla kolejnych pozycji w pasach.
+ * @param w Pierwsze słowo bloku.
+ * @param podstawa Podstawa bloku.
+ * @param wyjscie Bufor na ELEMENTY_BLOKU_KOMPRESJI wartości.
+ */
+template<int B, int... E>
+static void rozpakuj_kroki(const unsigned int* w, int podstawa, int* wyjscie, integer_sequence<int, E...>)
+{
+    (rozpakuj_krok<B, E>(w, (unsigned int)podstawa, wyjscie), ...);
+}
+
+/**
+ * @brief Rozpakowuje blok o B bitach na element.
+ * Element k leży w pasie k % PASY_KOMPRESJI na bitach (k / PASY_KOMPRESJI) * B słów tego pasa.
+ * @param w Pierwsze słowo bloku.
+ * @param podstawa Podstawa bloku.
+ * @param wyjscie Bufor na ELEMENTY_BLOKU_KOMPRESJI wartości.
+ */
+template<int B>
+static void rozpakuj_bity(const unsigned int* w, int podstawa, int* wyjscie)
+{
+    if constexpr (B == 0)
+    {
+        for (int k = 0; k < ELEMENTY_BLOKU_KOMPRESJI; k++)
+        {
+            wyjscie[k] = podstawa;
+        }
+    }
+    else
+    {
+        rozpakuj_kroki<B>(w, podstawa, wyjscie, make_integer_sequence<int, ELEMENTY_PASA>());
+    }
+}
+
+/**
+ * @brief Funkcja rozpakowująca blok o ustalonej liczbie bitów.
+ */
+typedef void (*rozpakowanie)(const unsigned int*, int, int*);
+
+/**
+ * @brief Buduje tablicę funkcji rozpakowujących dla kolejnych liczb bitów.
+ * @return Tablica indeksowana liczbą bitów.
+ */
+template<int... B>
+static constexpr array<rozpakowanie, sizeof...(B)> tablica_rozpakowan(integer_sequence<int, B...>)
+{
+    return { rozpakuj_bity<B>... };
+}
+
+/**
+ * @brief Funkcje rozpakowujące dla 0 - 32 bitów.
+ */
+static const array<rozpakowanie, 33> ROZPAKOWANIA = tablica_rozpakowan(make_integer_sequence<int, 33>());
+
+/**
+ * @brief Pakuje różnice elementów bloku od podstawy na b bitach (układ jak w rozpakuj_bity).
+ * @param we ELEMENTY_BLOKU_KOMPRESJI wartości.
+ * @param podstawa Podstawa bloku.
+ * @param b Liczba bitów (1 - 32).
+ * @param w Wyzerowane b * PASY_KOMPRESJI słów.
+ */
+static void spakuj_bity(const int* we, int podstawa, int b, unsigned int* w)
+{
+    for (int e = 0; e < ELEMENTY_PASA; e++)
+    {
+        const int bit = e * b;
+        const int s = bit & 31;
+        unsigned int* a = w + (bit >> 5) * PASY_KOMPRESJI;
+        const int* v = we + e * PASY_KOMPRESJI;
+        for (int l = 0; l < PASY_KOMPRESJI; l++)
+        {
+            unsigned int d = (unsigned int)v[l] - (unsigned int)podstawa;
+            a[l] |= d << s;
+            if (s + b > 32)
+            {
+                a[l + PASY_KOMPRESJI] |= d >> (32 - s);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Zwraca liczbę bitów potrzebną do zapisania różnicy.
+ * @param d Różnica.
+ * @return Liczba bitów (0 dla d = 0).
+ */
+static int bity_roznicy(unsigned int d)
+{
+    int b = 0;
+    while (b < 32 && (d >> b) != 0)
+    {
+        b++;
+    }
+    return b;
+}
+
+/**
+ * @brief Zwraca skrót wiersza używany do wyszukiwania wierszy identycznych.
+ * @param w Wiersz.
+ * @param n Długość wiersza.
+ * @return Skrót FNV-1a.
+ */
+static unsigned long long skrot_wiersza(const int* w, int n)
+{
+    unsigned long long h = 1469598103934665603ull;
+    for (int j = 0; j < n; j++)
+    {
+        h = (h ^ (unsigned int)w[j]) * 1099511628211ull;
+    }
+    return h;
+}
+
+/**
+ * @brief Tworzy skompresowaną postać macierzy m.
+ * @param m Macierz źródłowa.
+ */
+macierz_skompresowana::macierz_skompresowana(const matrix& m)
+{
+    kompresuj(m);
+}
+
+/**
+ * @brief Zwraca liczbę elementów macierzy w bloku j wiersza (ostatni blok może być niepełny).
+ * @param j Numer bloku w wierszu.
+ * @return Liczba elementów.
+ */
+int macierz_skompresowana::dlugosc_bloku(int j) const
+{
+    int reszta = n - j * ELEMENTY_BLOKU_KOMPRESJI;
+    return reszta < ELEMENTY_BLOKU_KOMPRESJI ? reszta : ELEMENTY_BLOKU_KOMPRESJI;
+}
+
+/**
+ * @brief Rozpakowuje cały blok (ELEMENTY_BLOKU_KOMPRESJI elementów) do bufora.
+ * Elementy za końcem wiersza w ostatnim bloku są równe podstawie.
+ * @param b Opis bloku.
+ * @param wyjscie Bufor na ELEMENTY_BLOKU_KOMPRESJI wartości.
+ */
+void macierz_skompresowana::rozpakuj_blok(const blok_kompresji& b, int* wyjscie) const
+{
+    ROZPAKOWANIA[b.bity](slowa.data() + b.slowo, b.podstawa, wyjscie);
+}
+
+/**
+ * @brief Kompresuje od nowa macierz m (także o innym rozmiarze).
+ * Wiersze są kodowane równolegle; wiersz równy wcześniejszemu wskazuje jego bloki.
+ * @param m Macierz źródłowa.
+ */
+void macierz_skompresowana::kompresuj(const matrix& m)
+{
+    n = m.dlug == nullptr ? 0 : *m.dlug;
+    MIERZ_OPERACJE(OP_KOMPRESJA, (long long)n * n * 2 * sizeof(int));
+    bloki_w_wierszu = (n + ELEMENTY_BLOKU_KOMPRESJI - 1) / ELEMENTY_BLOKU_KOMPRESJI;
+    vector<unsigned long long> skroty(n);
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int i = poczatek; i < koniec; i++)
+        {
+            skroty[i] = skrot_wiersza(m.mac[i], n);
+        }
+    });
+    zrodla.assign(n, 0);
+    unordered_map<unsigned long long, int> pierwsze;
+    for (int i = 0; i < n; i++)
+    {
+        auto it = pierwsze.find(skroty[i]);
+        if (it != pierwsze.end() && memcmp(m.mac[it->second], m.mac[i], (size_t)n * sizeof(int)) == 0)
+        {
+            zrodla[i] = it->second;
+            continue;
+        }
+        zrodla[i] = i;
+        if (it == pierwsze.end())
+        {
+            pierwsze.emplace(skroty[i], i);
+        }
+    }
+
+    vector<blok_kompresji> opisy((size_t)n * bloki_w_wierszu);
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int i = poczatek; i < koniec; i++)
+        {
+            if (zrodla[i] != i)
+            {
+                continue;
+            }
+            for (int j = 0; j < bloki_w_wierszu; j++)
+            {
+                const int* w = m.mac[i] + (size_t)j * ELEMENTY_BLOKU_KOMPRESJI;
+                int d = dlugosc_bloku(j);
+                int mn = w[0];
+                int mx = w[0];
+                for (int k = 1; k < d; k++)
+                {
+                    mn = w[k] < mn ? w[k] : mn;
+                    mx = w[k] > mx ? w[k] : mx;
+                }
+                opisy[(size_t)i * bloki_w_wierszu + j] = { mn, bity_roznicy((unsigned int)mx - (unsigned int)mn), 0 };
+            }
+        }
+    });
+    wiersze.assign(n, 0);
+    bloki.clear();
+    size_t slowo = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (zrodla[i] != i)
+        {
+            wiersze[i] = wiersze[zrodla[i]];
+            continue;
+        }
+        wiersze[i] = bloki.size();
+        for (int j = 0; j < bloki_w_wierszu; j++)
+        {
+            blok_kompresji b = opisy[(size_t)i * bloki_w_wierszu + j];
+            b.slowo = slowo;
+            slowo += (size_t)b.bity * PASY_KOMPRESJI;
+            bloki.push_back(b);
+        }
+    }
+    slowa.assign(slowo, 0);
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        int bufor[ELEMENTY_BLOKU_KOMPRESJI];
+        for (int i = poczatek; i < koniec; i++)
+        {
+            if (zrodla[i] != i)
+            {
+                continue;
+            }
+            for (int j = 0; j < bloki_w_wierszu; j++)
+            {
+                const blok_kompresji& b = bloki[wiersze[i] + j];
+                if (b.bity == 0)
+                {
+                    continue;
+                }
+                int d = dlugosc_bloku(j);
+                memcpy(bufor, m.mac[i] + (size_t)j * ELEMENTY_BLOKU_KOMPRESJI, (size_t)d * sizeof(int));
+                for (int k = d; k < ELEMENTY_BLOKU_KOMPRESJI; k++)
+                {
+                    bufor[k] = b.podstawa;
+                }
+                spakuj_bity(bufor, b.podstawa, b.bity, slowa.data() + b.slowo);
+            }
+        }
+    });
+}
+
+/**
+ * @brief Zwraca rozmiar macierzy.
+ * @return Rozmiar n.
+ */
+int macierz_skompresowana::rozmiar(void) const
+{
+    return n;
+}
+
+/**
+ * @brief Zwraca liczbę bajtów zajmowanych przez postać skompresowaną.
+ * @return Liczba bajtów opisów bloków, indeksów wierszy i upakowanych słów.
+ */
+size_t macierz_skompresowana::bajty(void) const
+{
+    return wiersze.size() * sizeof(size_t) + zrodla.size() * sizeof(int) + bloki.size() * sizeof(blok_kompresji)
+        + slowa.size() * sizeof(unsigned int);
+}
+
+/**
+ * @brief Zwraca wartość z określonej pozycji bez rozpakowywania bloku.
+ * @param x Wiersz.
+ * @param y Kolumna.
+ * @return Wartość elementu.
+ */
+int macierz_skompresowana::pokaz(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= n || y >= n)
+    {
+        cout << "Indeks poza zakresem macierzy" << endl;
+        return 0;
+    }
+    const blok_kompresji& b = bloki[wiersze[x] + y / ELEMENTY_BLOKU_KOMPRESJI];
+    if (b.bity == 0)
+    {
+        return b.podstawa;
+    }
+    int k = y % ELEMENTY_BLOKU_KOMPRESJI;
+    int bit = k / PASY_KOMPRESJI * b.bity;
+    int s = bit & 31;
+    const unsigned int* a = slowa.data() + b.slowo + (size_t)(bit >> 5) * PASY_KOMPRESJI + k % PASY_KOMPRESJI;
+    unsigned int v = a[0] >> s;
+    if (s + b.bity > 32)
+    {
+        v |= a[PASY_KOMPRESJI] << (32 - s);
+    }
+    return (int)((unsigned int)b.podstawa + (v & (unsigned int)((1ull << b.bity) - 1)));
+}
+
+/**
+ * @brief Zapisuje pełną postać macierzy do m, alokując ją w rozmiarze n.
+ * @param m Macierz docelowa.
+ */
+void macierz_skompresowana::rozpakuj(matrix& m) const
+{
+    MIERZ_OPERACJE(OP_KOMPRESJA, (long long)bajty() + (long long)n * n * sizeof(int));
+    m.alokuj(n);
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        int bufor[ELEMENTY_BLOKU_KOMPRESJI];
+        for (int i = poczatek; i < koniec; i++)
+        {
+            for (int j = 0; j < bloki_w_wierszu; j++)
+            {
+                int* w = m.mac[i] + (size_t)j * ELEMENTY_BLOKU_KOMPRESJI;
+                int d = dlugosc_bloku(j);
+                if (d == ELEMENTY_BLOKU_KOMPRESJI)
+                {
+                    rozpakuj_blok(bloki[wiersze[i] + j], w);
+                }
+                else
+                {
+                    rozpakuj_blok(bloki[wiersze[i] + j], bufor);
+                    memcpy(w, bufor, (size_t)d * sizeof(int));
+                }
+            }
+        }
+    });
+}
+
+/**
+ * @brief Zwraca sumę elementów.
+ * Każdy przechowywany wiersz jest sumowany raz i mnożony przez liczbę jego wystąpień.
+ * @return Suma w liczbie 64-bitowej.
+ */
+long long macierz_skompresowana::suma(void) const
+{
+    vector<long long> sumy_wierszy(n, 0);
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        int bufor[ELEMENTY_BLOKU_KOMPRESJI];
+        for (int i = poczatek; i < koniec; i++)
+        {
+            if (zrodla[i] != i)
+            {
+                continue;
+            }
+            long long s = 0;
+            for (int j = 0; j < bloki_w_wierszu; j++)
+            {
+                const blok_kompresji& b = bloki[wiersze[i] + j];
+                int d = dlugosc_bloku(j);
+                if (b.bity == 0)
+                {
+                    s += (long long)b.podstawa * d;
+                    continue;
+                }
+                rozpakuj_blok(b, bufor);
+                for (int k = 0; k < d; k++)
+                {
+                    s += bufor[k];
+                }
+            }
+            sumy_wierszy[i] = s;
+        }
+    });
+    long long s = 0;
+    for (int i = 0; i < n; i++)
+    {
+        s += sumy_wierszy[zrodla[i]];
+    }
+    return s;
+}
+
+/**
+ * @brief Zwraca najmniejszy element; czyta tylko opisy bloków.
+ * Podstawa bloku jest jego minimum (także dla niepełnego bloku, którego dopełnienie jej równa).
+ * @return Najmniejsza wartość.
+ */
+int macierz_skompresowana::minimum(void) const
+{
+    if (bloki.empty())
+    {
+        return 0;
+    }
+    int mn = bloki[0].podstawa;
+    for (size_t b = 1; b < bloki.size(); b++)
+    {
+        mn = bloki[b].podstawa < mn ? bloki[b].podstawa : mn;
+    }
+    return mn;
+}
+
+/**
+ * @brief Zwraca największy element; bloki, których podstawa i liczba bitów nie mogą przekroczyć
+ * bieżącego maksimum, nie są rozpakowywane.
+ * @return Największa wartość.
+ */
+int macierz_skompresowana::maksimum(void) const
+{
+    if (bloki.empty())
+    {
+        return 0;
+    }
+    vector<int> czesciowe(liczba_blokow(n), bloki[0].podstawa);
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        int bufor[ELEMENTY_BLOKU_KOMPRESJI];
+        int mx = bloki[0].podstawa;
+        for (int i = poczatek; i < koniec; i++)
+        {
+            if (zrodla[i] != i)
+            {
+                continue;
+            }
+            for (int j = 0; j < bloki_w_wierszu; j++)
+            {
+                const blok_kompresji& b = bloki[wiersze[i] + j];
+                if (b.podstawa + (long long)((1ull << b.bity) - 1) <= mx)
+                {
+                    continue;
+                }
+                if (b.bity == 0)
+                {
+                    mx = b.podstawa;
+                    continue;
+                }
+                rozpakuj_blok(b, bufor);
+                for (int k = 0; k < ELEMENTY_BLOKU_KOMPRESJI; k++)
+                {
+                    mx = bufor[k] > mx ? bufor[k] : mx;
+                }
+            }
+        }
+        czesciowe[blok] = mx;
+    });
+    int mx = czesciowe[0];
+    for (size_t b = 1; b < czesciowe.size(); b++)
+    {
+        mx = czesciowe[b] > mx ? czesciowe[b] : mx;
+    }
+    return mx;
+}
+
+/**
+ * @brief Sprawdza, czy macierz jest równa macierzy m.
+ * Bloki są rozpakowywane kolejno i porównywane z wierszami m; po pierwszej różnicy pozostałe wątki kończą pracę.
+ * @param m Macierz do porównania.
+ * @return true jeśli rozmiary i wszystkie elementy są równe.
+ */
+bool macierz_skompresowana::rowna(const matrix& m) const
+{
+    if ((m.dlug == nullptr ? 0 : *m.dlug) != n)
+    {
+        return false;
+    }
+    atomic<bool> rozne(false);
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        int bufor[ELEMENTY_BLOKU_KOMPRESJI];
+        for (int i = poczatek; i < koniec && !rozne.load(memory_order_relaxed); i++)
+        {
+            for (int j = 0; j < bloki_w_wierszu; j++)
+            {
+                rozpakuj_blok(bloki[wiersze[i] + j], bufor);
+                if (memcmp(bufor, m.mac[i] + (size_t)j * ELEMENTY_BLOKU_KOMPRESJI, (size_t)dlugosc_bloku(j) * sizeof(int)) != 0)
+                {
+                    rozne.store(true, memory_order_relaxed);
+                    break;
+                }
+            }
+        }
+    });
+    return !rozne.load();
+}
+
+/**
+ * @brief Dodaje macierz do m: m = m + this.
+ * Arytmetyka zawija modulo 2^32.
+ * @param m Macierz o rozmiarze n, nadpisywana wynikiem.
+ */
+void macierz_skompresowana::dodaj_do(matrix& m) const
+{
+    if ((m.dlug == nullptr ? 0 : *m.dlug) != n)
+    {
+        cout << "Macierze posiadaja rozne dlugosci" << endl;
+        return;
+    }
+    MIERZ_OPERACJE(OP_DODAWANIE, (long long)bajty() + (long long)n * n * 2 * sizeof(int));
+    m.odlacz();
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        int bufor[ELEMENTY_BLOKU_KOMPRESJI];
+        for (int i = poczatek; i < koniec; i++)
+        {
+            for (int j = 0; j < bloki_w_wierszu; j++)
+            {
+                const blok_kompresji& b = bloki[wiersze[i] + j];
+                int* w = m.mac[i] + (size_t)j * ELEMENTY_BLOKU_KOMPRESJI;
+                int d = dlugosc_bloku(j);
+                if (b.bity == 0)
+                {
+                    for (int k = 0; k < d; k++)
+                    {
+                        w[k] = (int)((unsigned int)w[k] + (unsigned int)b.podstawa);
+                    }
+                    continue;
+                }
+                rozpakuj_blok(b, bufor);
+                for (int k = 0; k < d; k++)
+                {
+                    w[k] = (int)((unsigned int)w[k] + (unsigned int)bufor[k]);
+                }
+            }
+        }
+    });
+}
+
+/**
+ * @brief Mnoży macierz przez wektor: y = this * x.
+ * Blok o podstawie p i różnicach d wnosi p * (suma x bloku) + d . x, a blok stały tylko pierwszy
+ * składnik; wiersze identyczne są liczone raz. Arytmetyka zawija modulo 2^32.
+ * @param x Wektor n wartości.
+ * @param y Bufor na n wartości wyniku (nie może pokrywać się z x).
+ */
+void macierz_skompresowana::mnoz_wektor(span<const int> x, span<int> y) const
+{
+    if (x.size() < (size_t)n || y.size() < (size_t)n)
+    {
+        cout << "Bufor jest za krotki" << endl;
+        return;
+    }
+    if (x.data() < y.data() + y.size() && y.data() < x.data() + x.size())
+    {
+        cout << "Wektory nie moga sie pokrywac" << endl;
+        return;
+    }
+    MIERZ_OPERACJE(OP_GEMV, (long long)bajty() + (long long)n * 2 * sizeof(int));
+    vector<unsigned int> sumy_x(bloki_w_wierszu, 0);
+    for (int j = 0; j < bloki_w_wierszu; j++)
+    {
+        for (int k = 0; k < dlugosc_bloku(j); k++)
+        {
+            sumy_x[j] += (unsigned int)x[(size_t)j * ELEMENTY_BLOKU_KOMPRESJI + k];
+        }
+    }
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        int bufor[ELEMENTY_BLOKU_KOMPRESJI];
+        for (int i = poczatek; i < koniec; i++)
+        {
+            if (zrodla[i] != i)
+            {
+                continue;
+            }
+            unsigned int s = 0;
+            for (int j = 0; j < bloki_w_wierszu; j++)
+            {
+                const blok_kompresji& b = bloki[wiersze[i] + j];
+                unsigned int p = (unsigned int)b.podstawa;
+                s += p * sumy_x[j];
+                if (b.bity == 0)
+                {
+                    continue;
+                }
+                rozpakuj_blok(b, bufor);
+                const int* xj = x.data() + (size_t)j * ELEMENTY_BLOKU_KOMPRESJI;
+                int d = dlugosc_bloku(j);
+                for (int k = 0; k < d; k++)
+                {
+                    s += ((unsigned int)bufor[k] - p) * (unsigned int)xj[k];
+                }
+            }
+            y[i] = (int)s;
+        }
+    });
+    for (int i = 0; i < n; i++)
+    {
+        y[i] = y[zrodla[i]];
+    }
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include <span>
+#include <vector>
+#include "matrix.h"
+using namespace std;
+
+/**
+ * @file skompresowana.h
+ * @brief Macierz przechowywana w postaci skompresowanej, przetwarzana blok po bloku.
+ */
+
+/**
+ * @brief Liczba elementw wiersza w jednym bloku kompresji.
+ */
+const int ELEMENTY_BLOKU_KOMPRESJI = 256;
+
+/**
+ * @brief Liczba pasw, na ktre przeplatane s elementy bloku (szeroko wektora 8 x int32).
+ */
+const int PASY_KOMPRESJI = 8;
+
+/**
+ * @class macierz_skompresowana
+ * @brief Macierz tylko do odczytu, w ktrej bloki wierszy s kodowane wzgldem minimum bloku z upakowaniem bitw.
+ *
+ * Kady blok ELEMENTY_BLOKU_KOMPRESJI kolumn wiersza przechowuje swoje minimum oraz rnice
+ * od niego zapisane na najmniejszej wystarczajcej liczbie bitw b (0 dla bloku staego, np. zer).
+ * Element k bloku ley w pasie k % PASY_KOMPRESJI, wic rozpakowanie przesuwa i maskuje osiem
+ * sw naraz. Identyczne wiersze s przechowywane raz. Sumowanie, porwnanie, dodawanie
+ * i mnoenie przez wektor rozpakowuj pojedyncze bloki do bufora w pamici podrcznej
+ * i czytaj tyle bajtw, ile zajmuje posta skompresowana. Dla wartoci z penego zakresu int
+ * posta skompresowana jest nieco wiksza od zwykej (dopenienie ostatniego bloku wiersza).
+ */
+class macierz_skompresowana {
+private:
+    /**
+     * @struct blok_kompresji
+     * @brief Opis jednego bloku wiersza.
+     */
+    struct blok_kompresji {
+        int podstawa; ///< Najmniejszy element bloku.
+        int bity; ///< Liczba bitw rnicy od podstawy (0 - 32).
+        size_t slowo; ///< Indeks pierwszego sowa bloku w tablicy slowa.
+    };
+
+    int n = 0; ///< Rozmiar macierzy.
+    int bloki_w_wierszu = 0; ///< Liczba blokw w wierszu.
+    vector<size_t> wiersze; ///< Indeks pierwszego bloku kadego wiersza (wiersze identyczne dziel bloki).
+    vector<int> zrodla; ///< Pierwszy wiersz rwny danemu (i dla wiersza przechowywanego).
+    vector<blok_kompresji> bloki; ///< Opisy blokw.
+    vector<unsigned int> slowa; ///< Upakowane rnice; blok o b bitach zajmuje b * PASY_KOMPRESJI sw.
+
+    /**
+     * @brief Zwraca liczb elementw macierzy w bloku j wiersza (ostatni blok moe by niepeny).
+     * @param j Numer bloku w wierszu.
+     * @return Liczba elementw.
+     */
+    int dlugosc_bloku(int j) const;
+
+    /**
+     * @brief Rozpakowuje cay blok (ELEMENTY_BLOKU_KOMPRESJI elementw) do bufora.
+     * @param b Opis bloku.
+     * @param wyjscie Bufor na ELEMENTY_BLOKU_KOMPRESJI wartoci.
+     */
+    void rozpakuj_blok(const blok_kompresji& b, int* wyjscie) const;
+
+public:
+    /**
+     * @brief Tworzy skompresowan posta macierzy m.
+     * @param m Macierz rdowa.
+     */
+    macierz_skompresowana(const matrix& m);
+
+    /**
+     * @brief Kompresuje od nowa macierz m (take o innym rozmiarze).
+     * Wiersze s kodowane rwnolegle; wiersz rwny wczeniejszemu wskazuje jego bloki.
+     * @param m Macierz rdowa.
+     */
+    void kompresuj(const matrix& m);
+
+    /**
+     * @brief Zwraca rozmiar macierzy.
+     * @return Rozmiar n.
+     */
+    int rozmiar(void) const;
+
+    /**
+     * @brief Zwraca liczb bajtw zajmowanych przez posta skompresowan.
+     * @return Liczba bajtw opisw blokw, indeksw wierszy i upakowanych sw.
+     */
+    size_t bajty(void) const;
+
+    /**
+     * @brief Zwraca warto z okrelonej pozycji bez rozpakowywania bloku.
+     * @param x Wiersz.
+     * @param y Kolumna.
+     * @return Warto elementu.
+     */
+    int pokaz(int x, int y) const;
+
+    /**
+     * @brief Zapisuje pen posta macierzy do m, alokujc j w rozmiarze n.
+     * @param m Macierz docelowa.
+     */
+    void rozpakuj(matrix& m) const;
+
+    /**
+     * @brief Zwraca sum elementw.
+     * @return Suma w liczbie 64-bitowej.
+     */
+    long long suma(void) const;
+
+    /**
+     * @brief Zwraca najmniejszy element; czyta tylko opisy blokw.
+     * @return Najmniejsza warto.
+     */
+    int minimum(void) const;
+
+    /**
+     * @brief Zwraca najwikszy element; bloki, ktrych podstawa i liczba bitw nie mog przekroczy
+     * biecego maksimum, nie s rozpakowywane.
+     * @return Najwiksza warto.
+     */
+    int maksimum(void) const;
+
+    /**
+     * @brief Sprawdza, czy macierz jest rwna macierzy m.
+     * @param m Macierz do porwnania.
+     * @return true jeli rozmiary i wszystkie elementy s rwne.
+     */
+    bool rowna(const matrix& m) const;
+
+    /**
+     * @brief Dodaje macierz do m: m = m + this.
+     * Arytmetyka zawija modulo 2^32.
+     * @param m Macierz o rozmiarze n, nadpisywana wynikiem.
+     */
+    void dodaj_do(matrix& m) const;
+
+    /**
+     * @brief Mnoy macierz przez wektor: y = this * x.
+     * Blok o podstawie p i rnicach d wnosi p * (suma x bloku) + d . x, a blok stay tylko pierwszy
+     * skadnik; wiersze identyczne s liczone raz. Arytmetyka zawija modulo 2^32.
+     * @param x Wektor n wartoci.
+     * @param y Bufor na n wartoci wyniku (nie moe pokrywa si z x).
+     */
+    void mnoz_wektor(span<const int> x, span<int> y) const;
+};
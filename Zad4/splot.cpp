@@ -0,0 +1,391 @@
+#include "splot.h"
+#include <iostream>
+#include <cstring>
+#include <vector>
+#include "watki.h"
+#include "metryki.h"
+using namespace std;
+
+/**
+ * @brief Wyznacza indeks elementu, który zastępuje element o indeksie k leżący poza [0, n).
+ * @param k Indeks (wiersza lub kolumny).
+ * @param n Rozmiar macierzy.
+ * @param brzeg Tryb brzegu.
+ * @return Indeks z przedziału [0, n) lub -1, gdy element jest równy 0.
+ */
+static int mapuj(int k, int n, tryb_brzegu brzeg)
+{
+    if (k >= 0 && k < n)
+    {
+        return k;
+    }
+    switch (brzeg)
+    {
+    case BRZEG_ZERA:
+        return -1;
+    case BRZEG_POWIELENIE:
+        return k < 0 ? 0 : n - 1;
+    case BRZEG_ODBICIE:
+    {
+        if (n == 1)
+        {
+            return 0;
+        }
+        int okres = 2 * n - 2;
+        k %= okres;
+        if (k < 0)
+        {
+            k += okres;
+        }
+        return k < n ? k : okres - k;
+    }
+    default:
+        k %= n;
+        return k < 0 ? k + n : k;
+    }
+}
+
+/**
+ * @brief Tworzy jądro splotu.
+ * @param promien Promień r jądra (r >= 0).
+ * @param wagi (2r + 1) x (2r + 1) wag wierszami.
+ * @param dzielnik Dzielnik sumy (dodatni, więc iloraz zawsze mieści się w int).
+ * @param brzeg Tryb brzegu.
+ */
+szablon_splotu::szablon_splotu(int promien, span<const int> wagi, int dzielnik, tryb_brzegu brzeg)
+{
+    if (promien < 0)
+    {
+        cout << "Promien jadra musi byc nieujemny" << endl;
+        promien = 0;
+    }
+    if (dzielnik <= 0)
+    {
+        cout << "Dzielnik musi byc dodatni" << endl;
+        dzielnik = 1;
+    }
+    this->promien = promien;
+    this->dzielnik = dzielnik;
+    this->brzeg = brzeg;
+    wykladnik = -1;
+    for (int k = 0; k < 31; k++)
+    {
+        if (dzielnik == 1 << k)
+        {
+            wykladnik = k;
+        }
+    }
+    size_t d = 2 * promien + 1;
+    this->wagi = new int[d * d];
+    if (wagi.size() < d * d)
+    {
+        cout << "Za malo wag jadra splotu" << endl;
+        memset(this->wagi, 0, d * d * sizeof(int));
+        return;
+    }
+    memcpy(this->wagi, wagi.data(), d * d * sizeof(int));
+}
+
+/**
+ * @brief Konstruktor kopiujący.
+ * @param s Obiekt do skopiowania.
+ */
+szablon_splotu::szablon_splotu(const szablon_splotu& s)
+{
+    promien = s.promien;
+    dzielnik = s.dzielnik;
+    wykladnik = s.wykladnik;
+    brzeg = s.brzeg;
+    size_t d = 2 * promien + 1;
+    wagi = new int[d * d];
+    memcpy(wagi, s.wagi, d * d * sizeof(int));
+}
+
+/**
+ * @brief Operator przypisania.
+ * @param s Obiekt do skopiowania.
+ * @return Referencja do obiektu.
+ */
+szablon_splotu& szablon_splotu::operator=(const szablon_splotu& s)
+{
+    if (this != &s)
+    {
+        delete[] wagi;
+        promien = s.promien;
+        dzielnik = s.dzielnik;
+        wykladnik = s.wykladnik;
+        brzeg = s.brzeg;
+        size_t d = 2 * promien + 1;
+        wagi = new int[d * d];
+        memcpy(wagi, s.wagi, d * d * sizeof(int));
+    }
+    return *this;
+}
+
+/**
+ * @brief Destruktor.
+ */
+szablon_splotu::~szablon_splotu(void)
+{
+    delete[] wagi;
+}
+
+/**
+ * @brief Liczy jeden wiersz wyniku z 2r + 1 wierszy wejścia.
+ * Kolumny są przetwarzane pasami KOLUMNY_W_KAFELKU. We wnętrzu pasa każda waga jest
+ * dodawana do całego bufora sum jedną pętlą bez rozgałęzień, którą kompilator
+ * wektoryzuje; tylko r kolumn przy każdym brzegu korzysta z odwzorowania indeksów.
+ * Dzielenie przez potęgę dwójki jest zastępowane przesunięciem z zaokrągleniem do zera.
+ * @param wiersze Wskaźniki na wiersze wejścia od -r do r względem wiersza wyniku (nullptr - wiersz zer).
+ * @param wy Wiersz wyniku.
+ * @param n Liczba kolumn.
+ */
+void szablon_splotu::licz_wiersz(const int* const* wiersze, int* wy, int n) const
+{
+    int r = promien;
+    int d = 2 * r + 1;
+    unsigned int suma[KOLUMNY_W_KAFELKU];
+    for (int c0 = 0; c0 < n; c0 += KOLUMNY_W_KAFELKU)
+    {
+        int c1 = c0 + KOLUMNY_W_KAFELKU < n ? c0 + KOLUMNY_W_KAFELKU : n;
+        int j0 = c0 > r ? c0 : r;
+        int j1 = c1 < n - r ? c1 : n - r;
+        if (j0 > j1)
+        {
+            j0 = c1;
+            j1 = c1;
+        }
+        for (int j = c0; j < c1; j++)
+        {
+            suma[j - c0] = 0;
+        }
+        for (int di = 0; di < d; di++)
+        {
+            const int* w = wiersze[di];
+            if (w == nullptr)
+            {
+                continue;
+            }
+            for (int dj = 0; dj < d; dj++)
+            {
+                unsigned int waga = wagi[di * d + dj];
+                if (waga == 0)
+                {
+                    continue;
+                }
+                const int* zrodlo = w + dj - r;
+                unsigned int* s = suma - c0;
+                for (int j = j0; j < j1; j++)
+                {
+                    s[j] += waga * (unsigned int)zrodlo[j];
+                }
+                for (int j = c0; j < c1; j++)
+                {
+                    if (j == j0)
+                    {
+                        j = j1;
+                        if (j >= c1)
+                        {
+                            break;
+                        }
+                    }
+                    int k = mapuj(j + dj - r, n, brzeg);
+                    if (k >= 0)
+                    {
+                        s[j] += waga * (unsigned int)w[k];
+                    }
+                }
+            }
+        }
+        if (dzielnik == 1)
+        {
+            for (int j = c0; j < c1; j++)
+            {
+                wy[j] = (int)suma[j - c0];
+            }
+        }
+        else if (wykladnik > 0)
+        {
+            int maska = (1 << wykladnik) - 1;
+            for (int j = c0; j < c1; j++)
+            {
+                int x = (int)suma[j - c0];
+                wy[j] = (x + ((x >> 31) & maska)) >> wykladnik;
+            }
+        }
+        else
+        {
+            for (int j = c0; j < c1; j++)
+            {
+                wy[j] = (int)suma[j - c0] / dzielnik;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Wykonuje jeden krok splotu: wy = jądro * we.
+ * Wejście jest najpierw kopiowane (bez kopiowania danych, dzięki współdzieleniu bufora),
+ * więc wy może być tą samą macierzą co we - alokuj przydzieli wtedy nowy bufor.
+ * @param we Macierz wejściowa.
+ * @param wy Macierz wynikowa.
+ */
+void szablon_splotu::zastosuj(matrix& we, matrix& wy) const
+{
+    matrix zrodlo(we);
+    int n = *zrodlo.dlug;
+    int r = promien;
+    int d = 2 * r + 1;
+    MIERZ_OPERACJE(OP_SPLOT, (long long)n * n * 2 * sizeof(int));
+    wy.alokuj(n);
+    rownolegle(n, (long long)n * n * d * d, [&](int blok, int poczatek, int koniec) {
+        vector<const int*> wiersze(d);
+        for (int i = poczatek; i < koniec; i++)
+        {
+            for (int di = 0; di < d; di++)
+            {
+                int g = mapuj(i + di - r, n, brzeg);
+                wiersze[di] = g < 0 ? nullptr : zrodlo.mac[g];
+            }
+            licz_wiersz(wiersze.data(), wy.mac[i], n);
+        }
+    });
+}
+
+/**
+ * @brief Wykonuje do KROKI_W_BLOKU kroków iteracji z macierzy we do wy z blokowaniem czasowym.
+ * Blok wierszy [a, b) kopiuje okno [a - h, b + h), h = kroki * r, i w kroku s liczy okno
+ * pomniejszone o s * r wierszy z każdej strony, więc po ostatnim kroku poprawne są
+ * dokładnie wiersze [a, b). Okno przycięte do brzegu macierzy nie jest pomniejszane
+ * z tej strony, a wiersze spoza macierzy są odwzorowywane na wiersze okna. Przy zawijaniu
+ * okno nie jest przycinane, tylko jego wiersze są brane modulo n.
+ * @param we Macierz wejściowa.
+ * @param wy Macierz wynikowa (inny bufor niż we).
+ * @param kroki Liczba kroków.
+ */
+void szablon_splotu::kroki_blokowo(const matrix& we, matrix& wy, int kroki) const
+{
+    int n = *we.dlug;
+    int r = promien;
+    int d = 2 * r + 1;
+    int h = kroki * r;
+    bool torus = brzeg == BRZEG_ZAWIJANIE;
+    rownolegle(n, (long long)n * n * d * d * kroki, [&](int blok, int a, int b) {
+        int lo = a - h;
+        int hi = b + h;
+        if (!torus)
+        {
+            lo = lo > 0 ? lo : 0;
+            hi = hi < n ? hi : n;
+        }
+        size_t wys = hi - lo;
+        vector<int> bufory(2 * wys * n);
+        int* stary = bufory.data();
+        int* nowy = stary + wys * n;
+        for (int g = lo; g < hi; g++)
+        {
+            memcpy(stary + (size_t)(g - lo) * n, we.mac[mapuj(g, n, BRZEG_ZAWIJANIE)], n * sizeof(int));
+        }
+        vector<const int*> wiersze(d);
+        for (int s = 1; s <= kroki; s++)
+        {
+            int od = (!torus && lo == 0) ? 0 : lo + s * r;
+            int az = (!torus && hi == n) ? n : hi - s * r;
+            for (int g = od; g < az; g++)
+            {
+                for (int di = 0; di < d; di++)
+                {
+                    int k = g + di - r;
+                    if (!torus)
+                    {
+                        k = mapuj(k, n, brzeg);
+                    }
+                    wiersze[di] = k < 0 && !torus ? nullptr : stary + (size_t)(k - lo) * n;
+                }
+                licz_wiersz(wiersze.data(), nowy + (size_t)(g - lo) * n, n);
+            }
+            swap(stary, nowy);
+        }
+        for (int g = a; g < b; g++)
+        {
+            memcpy(wy.mac[g], stary + (size_t)(g - lo) * n, n * sizeof(int));
+        }
+    });
+}
+
+/**
+ * @brief Wykonuje kroki splotu w miejscu, po KROKI_W_BLOKU kroków na jeden przebieg po pamięci.
+ * Dwa bufory są wymieniane między przebiegami, więc pamięć jest przydzielana raz.
+ * @param m Macierz przetwarzana w miejscu.
+ * @param kroki Liczba kroków.
+ */
+void szablon_splotu::iteruj(matrix& m, int kroki) const
+{
+    if (kroki < 0)
+    {
+        cout << "Liczba krokow musi byc nieujemna" << endl;
+        return;
+    }
+    MIERZ_OPERACJE(OP_SPLOT, (long long)*m.dlug * *m.dlug * 2 * sizeof(int) * ((kroki + KROKI_W_BLOKU - 1) / KROKI_W_BLOKU));
+    matrix bufor;
+    while (kroki > 0)
+    {
+        int t = kroki < KROKI_W_BLOKU ? kroki : KROKI_W_BLOKU;
+        bufor.alokuj(*m.dlug);
+        kroki_blokowo(m, bufor, t);
+        m.zamien(bufor);
+        kroki -= t;
+    }
+}
+
+/**
+ * @brief Rozmycie 3 x 3 (wagi 1 2 1 / 2 4 2 / 1 2 1, dzielnik 16).
+ * @param brzeg Tryb brzegu.
+ * @return Jądro splotu.
+ */
+szablon_splotu szablon_splotu::rozmycie_3x3(tryb_brzegu brzeg)
+{
+    static const int w[9] = { 1, 2, 1, 2, 4, 2, 1, 2, 1 };
+    return szablon_splotu(1, w, 16, brzeg);
+}
+
+/**
+ * @brief Rozmycie 5 x 5 (wagi dwumianowe 1 4 6 4 1, dzielnik 256).
+ * @param brzeg Tryb brzegu.
+ * @return Jądro splotu.
+ */
+szablon_splotu szablon_splotu::rozmycie_5x5(tryb_brzegu brzeg)
+{
+    static const int p[5] = { 1, 4, 6, 4, 1 };
+    int w[25];
+    for (int i = 0; i < 5; i++)
+    {
+        for (int j = 0; j < 5; j++)
+        {
+            w[i * 5 + j] = p[i] * p[j];
+        }
+    }
+    return szablon_splotu(2, w, 256, brzeg);
+}
+
+/**
+ * @brief Laplasjan 3 x 3 (0 1 0 / 1 -4 1 / 0 1 0).
+ * @param brzeg Tryb brzegu.
+ * @return Jądro splotu.
+ */
+szablon_splotu szablon_splotu::laplasjan(tryb_brzegu brzeg)
+{
+    static const int w[9] = { 0, 1, 0, 1, -4, 1, 0, 1, 0 };
+    return szablon_splotu(1, w, 1, brzeg);
+}
+
+/**
+ * @brief Liczba sąsiadów w sąsiedztwie Moore'a (wagi 1 wokół zera w środku).
+ * @param brzeg Tryb brzegu.
+ * @return Jądro splotu.
+ */
+szablon_splotu szablon_splotu::sasiedzi(tryb_brzegu brzeg)
+{
+    static const int w[9] = { 1, 1, 1, 1, 0, 1, 1, 1, 1 };
+    return szablon_splotu(1, w, 1, brzeg);
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <span>
+#include "matrix.h"
+using namespace std;
+
+/**
+ * @file splot.h
+ * @brief Splot dwuwymiarowy (szablon ssiedztwa) na macierzach z wybran obsug brzegu.
+ */
+
+/**
+ * @brief Liczba krokw iteracji liczonych dla jednego bloku wierszy bez powrotu do pamici gwnej.
+ */
+const int KROKI_W_BLOKU = 4;
+
+/**
+ * @brief Szeroko pasa kolumn, dla ktrego sumy s zbierane w buforze lokalnym.
+ */
+const int KOLUMNY_W_KAFELKU = 512;
+
+/**
+ * @brief Sposb uzupeniania elementw lecych poza macierz.
+ */
+enum tryb_brzegu {
+    BRZEG_ZERA,       ///< Elementy poza macierz s rwne 0.
+    BRZEG_POWIELENIE, ///< Powielany jest najbliszy element brzegowy.
+    BRZEG_ODBICIE,    ///< Odbicie wzgldem brzegu bez powtrzenia elementu brzegowego (-1 -> 1).
+    BRZEG_ZAWIJANIE   ///< Macierz zawinita w torus (-1 -> n - 1).
+};
+
+/**
+ * @class szablon_splotu
+ * @brief Jdro splotu o rozmiarze (2r + 1) x (2r + 1) z dzielnikiem i trybem brzegu.
+ *
+ * Element wyniku to suma wag pomnoonych przez ssiadw (z zawijaniem modulo 2^32),
+ * podzielona cakowitoliczbowo przez dzielnik. Wiersze s przetwarzane blokami rwnolegle,
+ * a kolumny pasami KOLUMNY_W_KAFELKU, ktrych sumy mieszcz si w pamici podrcznej L1.
+ */
+class szablon_splotu {
+private:
+    int promien; ///< Promie r jdra.
+    int* wagi; ///< Wagi (2r + 1) x (2r + 1) wierszami.
+    int dzielnik; ///< Dzielnik sumy.
+    int wykladnik; ///< log2(dzielnik), gdy dzielnik jest dodatni potg dwjki, w przeciwnym razie -1.
+    tryb_brzegu brzeg; ///< Tryb brzegu.
+
+    /**
+     * @brief Liczy jeden wiersz wyniku z 2r + 1 wierszy wejcia.
+     * @param wiersze Wskaniki na wiersze wejcia od -r do r wzgldem wiersza wyniku (nullptr - wiersz zer).
+     * @param wy Wiersz wyniku.
+     * @param n Liczba kolumn.
+     */
+    void licz_wiersz(const int* const* wiersze, int* wy, int n) const;
+
+    /**
+     * @brief Wykonuje do KROKI_W_BLOKU krokw iteracji z macierzy we do wy z blokowaniem czasowym.
+     * @param we Macierz wejciowa.
+     * @param wy Macierz wynikowa (inny bufor ni we).
+     * @param kroki Liczba krokw.
+     */
+    void kroki_blokowo(const matrix& we, matrix& wy, int kroki) const;
+
+public:
+    /**
+     * @brief Tworzy jdro splotu.
+     * @param promien Promie r jdra (r >= 0).
+     * @param wagi (2r + 1) x (2r + 1) wag wierszami.
+     * @param dzielnik Dzielnik sumy (dodatni, wic iloraz zawsze mieci si w int).
+     * @param brzeg Tryb brzegu.
+     */
+    szablon_splotu(int promien, span<const int> wagi, int dzielnik = 1, tryb_brzegu brzeg = BRZEG_ZERA);
+
+    /**
+     * @brief Konstruktor kopiujcy.
+     * @param s Obiekt do skopiowania.
+     */
+    szablon_splotu(const szablon_splotu& s);
+
+    /**
+     * @brief Operator przypisania.
+     * @param s Obiekt do skopiowania.
+     * @return Referencja do obiektu.
+     */
+    szablon_splotu& operator=(const szablon_splotu& s);
+
+    /**
+     * @brief Destruktor.
+     */
+    ~szablon_splotu(void);
+
+    /**
+     * @brief Wykonuje jeden krok splotu: wy = jdro * we.
+     * Rozmiar wy jest ustawiany przez alokuj; wy moe by t sam macierz co we.
+     * @param we Macierz wejciowa.
+     * @param wy Macierz wynikowa.
+     */
+    void zastosuj(matrix& we, matrix& wy) const;
+
+    /**
+     * @brief Wykonuje kroki splotu w miejscu, po KROKI_W_BLOKU krokw na jeden przebieg po pamici.
+     * Kady blok wierszy kopiuje swoje wiersze z zakadk KROKI_W_BLOKU * r wierszy do bufora
+     * lokalnego i liczy w nim kolejne kroki, powtarzajc obliczenia na zakadce zamiast
+     * synchronizowa wtki po kadym kroku.
+     * @param m Macierz przetwarzana w miejscu.
+     * @param kroki Liczba krokw.
+     */
+    void iteruj(matrix& m, int kroki) const;
+
+    /**
+     * @brief Rozmycie 3 x 3 (wagi 1 2 1 / 2 4 2 / 1 2 1, dzielnik 16).
+     * @param brzeg Tryb brzegu.
+     * @return Jdro splotu.
+     */
+    static szablon_splotu rozmycie_3x3(tryb_brzegu brzeg = BRZEG_POWIELENIE);
+
+    /**
+     * @brief Rozmycie 5 x 5 (wagi dwumianowe 1 4 6 4 1, dzielnik 256).
+     * @param brzeg Tryb brzegu.
+     * @return Jdro splotu.
+     */
+    static szablon_splotu rozmycie_5x5(tryb_brzegu brzeg = BRZEG_POWIELENIE);
+
+    /**
+     * @brief Laplasjan 3 x 3 (0 1 0 / 1 -4 1 / 0 1 0).
+     * @param brzeg Tryb brzegu.
+     * @return Jdro splotu.
+     */
+    static szablon_splotu laplasjan(tryb_brzegu brzeg = BRZEG_POWIELENIE);
+
+    /**
+     * @brief Liczba ssiadw w ssiedztwie Moore'a (wagi 1 wok zera w rodku).
+     * @param brzeg Tryb brzegu.
+     * @return Jdro splotu.
+     */
+    static szablon_splotu sasiedzi(tryb_brzegu brzeg = BRZEG_ZERA);
+};
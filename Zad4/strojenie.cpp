@@ -0,0 +1,415 @@
+#include "strojenie.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <vector>
+#include "matrix.h"
+#include "watki.h"
+#ifdef _WIN32
+#include <intrin.h>
+#endif
+using namespace std;
+
+#if defined(__AVXVNNI__) || defined(__AVX512VNNI__)
+/**
+ * @brief Domyślna ścieżka mnożenia: z VNNI (vpdpbusd) bajty są mnożone dwa razy szybciej niż pary int16.
+ */
+static const sciezka_mnozenia DOMYSLNA_SCIEZKA = SCIEZKA_8;
+#else
+/**
+ * @brief Domyślna ścieżka mnożenia: bez VNNI rozszerzanie bajtów czyni ścieżkę 8-bitową wolniejszą od 16-bitowej.
+ */
+static const sciezka_mnozenia DOMYSLNA_SCIEZKA = SCIEZKA_16;
+#endif
+
+/**
+ * @brief Rozmiary macierzy, na których mierzona jest każda klasa rozmiaru.
+ */
+static const int ROZMIARY_POMIAROWE[LICZBA_KLAS_ROZMIARU] = { 64, 256, 512 };
+
+/**
+ * @brief Bieżące konfiguracje klas rozmiaru (chronione przez blokada_konfiguracji).
+ */
+static konfiguracja_jader konfiguracje[LICZBA_KLAS_ROZMIARU] = {
+    { 64, 32, 0, DOMYSLNA_SCIEZKA },
+    { 64, 32, 0, DOMYSLNA_SCIEZKA },
+    { 64, 32, 0, DOMYSLNA_SCIEZKA }
+};
+
+/**
+ * @brief Chroni wczytywanie i strojenie konfiguracji.
+ */
+static mutex blokada;
+
+/**
+ * @brief Chroni tablicę konfiguracje; trzymana tylko na czas skopiowania wpisu.
+ */
+static mutex blokada_konfiguracji;
+
+/**
+ * @brief Ścieżka pliku podręcznego podana w wlacz_strojenie.
+ */
+static string plik_podreczny;
+
+/**
+ * @brief Czy pierwsze użycie konfiguracji ma ją wczytać lub nastroić.
+ */
+static atomic<bool> do_strojenia(false);
+
+/**
+ * @brief Konfiguracja próbna mierzona przez bieżący wątek (nullptr poza strojeniem).
+ */
+static thread_local const konfiguracja_jader* proba = nullptr;
+
+/**
+ * @brief Klasa rozmiaru, której dotyczy konfiguracja próbna.
+ */
+static thread_local int klasa_proby = -1;
+
+/**
+ * @brief Zwraca klasę rozmiaru macierzy n x n.
+ * @param n Rozmiar macierzy.
+ * @return 0 dla n < 128, 1 dla n < 512, 2 dla większych.
+ */
+int klasa_rozmiaru(int n)
+{
+    return n < 128 ? 0 : (n < 512 ? 1 : 2);
+}
+
+/**
+ * @brief Zwraca identyfikator procesora, pod którym zapisywane są wyniki strojenia.
+ * @return Nazwa procesora i liczba wątków puli.
+ */
+string identyfikator_procesora(void)
+{
+    string nazwa;
+#ifdef _WIN32
+    int r[12];
+    __cpuid(r, 0x80000000);
+    if ((unsigned int)r[0] >= 0x80000004)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            __cpuid(r + 4 * i, 0x80000002 + i);
+        }
+        nazwa = string((const char*)r, sizeof(r)).c_str();
+    }
+#else
+    ifstream f("/proc/cpuinfo");
+    string linia;
+    while (getline(f, linia))
+    {
+        if (linia.compare(0, 10, "model name") == 0 && linia.find(':') != string::npos)
+        {
+            nazwa = linia.substr(linia.find(':') + 1);
+            break;
+        }
+    }
+#endif
+    size_t poczatek = nazwa.find_first_not_of(' ');
+    nazwa = poczatek == string::npos ? "nieznany" : nazwa.substr(poczatek);
+    return nazwa + " x" + to_string(liczba_watkow());
+}
+
+/**
+ * @brief Wczytuje z pliku konfiguracje bieżącego procesora.
+ * Wiersz pliku ma postać: identyfikator, tabulator, klasa pas kafelek watki sciezka.
+ * @param plik Ścieżka pliku.
+ * @return true jeśli plik zawiera poprawne wpisy dla wszystkich klas rozmiaru.
+ */
+static bool wczytaj(const string& plik)
+{
+    ifstream f(plik);
+    if (!f)
+    {
+        return false;
+    }
+    string id = identyfikator_procesora() + '\t';
+    konfiguracja_jader nowe[LICZBA_KLAS_ROZMIARU];
+    bool wczytane[LICZBA_KLAS_ROZMIARU] = {};
+    string linia;
+    while (getline(f, linia))
+    {
+        if (linia.compare(0, id.size(), id) != 0)
+        {
+            continue;
+        }
+        istringstream s(linia.substr(id.size()));
+        int klasa, pas, kafelek, watki, sciezka;
+        if (s >> klasa >> pas >> kafelek >> watki >> sciezka && klasa >= 0 && klasa < LICZBA_KLAS_ROZMIARU
+            && pas > 0 && kafelek > 0 && watki >= 0 && sciezka >= SCIEZKA_32 && sciezka <= SCIEZKA_8)
+        {
+            nowe[klasa] = { pas, kafelek, watki, (sciezka_mnozenia)sciezka };
+            wczytane[klasa] = true;
+        }
+    }
+    for (int k = 0; k < LICZBA_KLAS_ROZMIARU; k++)
+    {
+        if (!wczytane[k])
+        {
+            return false;
+        }
+    }
+    lock_guard<mutex> l(blokada_konfiguracji);
+    for (int k = 0; k < LICZBA_KLAS_ROZMIARU; k++)
+    {
+        konfiguracje[k] = nowe[k];
+    }
+    return true;
+}
+
+/**
+ * @brief Zapisuje konfiguracje bieżącego procesora, zachowując w pliku wpisy innych procesorów.
+ * Nowa zawartość trafia do pliku tymczasowego, który zastępuje plik docelowy dopiero po pełnym
+ * zapisie, więc przerwany zapis ani równoległy odczyt nie widzą pliku obciętego.
+ * @param plik Ścieżka pliku.
+ * @return false jeśli nie udało się zapisać pliku.
+ */
+static bool zapisz(const string& plik)
+{
+    string id = identyfikator_procesora() + '\t';
+    vector<string> inne;
+    {
+        ifstream f(plik);
+        string linia;
+        while (getline(f, linia))
+        {
+            if (linia.compare(0, id.size(), id) != 0)
+            {
+                inne.push_back(linia);
+            }
+        }
+    }
+    konfiguracja_jader zapisywane[LICZBA_KLAS_ROZMIARU];
+    {
+        lock_guard<mutex> l(blokada_konfiguracji);
+        for (int k = 0; k < LICZBA_KLAS_ROZMIARU; k++)
+        {
+            zapisywane[k] = konfiguracje[k];
+        }
+    }
+    string tymczasowy = plik + ".tmp";
+    {
+        ofstream f(tymczasowy, ios::trunc);
+        for (size_t i = 0; i < inne.size(); i++)
+        {
+            f << inne[i] << '\n';
+        }
+        for (int k = 0; k < LICZBA_KLAS_ROZMIARU; k++)
+        {
+            const konfiguracja_jader& c = zapisywane[k];
+            f << id << k << ' ' << c.pas_mnozenia << ' ' << c.kafelek_transpozycji << ' ' << c.watki << ' ' << (int)c.sciezka << '\n';
+        }
+        f.close();
+        if (!f)
+        {
+            remove(tymczasowy.c_str());
+            return false;
+        }
+    }
+    error_code blad;
+    filesystem::rename(tymczasowy, plik, blad);
+    if (blad)
+    {
+        remove(tymczasowy.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Zwraca najkrótszy czas wykonania operacji w sekundach.
+ * Operacja trwająca ponad 50 ms jest mierzona raz, krótsza - do czterech razy (pierwszy pomiar to rozgrzewka).
+ * @param f Operacja.
+ * @return Czas w sekundach.
+ */
+static double zmierz(const function<void(void)>& f)
+{
+    double najlepszy = 0;
+    double lacznie = 0;
+    for (int r = 0; r < 4 && lacznie < 0.05; r++)
+    {
+        auto t0 = chrono::steady_clock::now();
+        f();
+        double t = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        najlepszy = r <= 1 || t < najlepszy ? t : najlepszy;
+        lacznie += t;
+    }
+    return najlepszy;
+}
+
+/**
+ * @brief Ustawia parametr na tego z kandydatów, dla którego operacja trwa najkrócej.
+ * @param parametr Strojony parametr konfiguracji.
+ * @param kandydaci Sprawdzane wartości.
+ * @param f Mierzona operacja.
+ */
+static void wybierz(int& parametr, const vector<int>& kandydaci, const function<void(void)>& f)
+{
+    int najlepszy = parametr;
+    double czas = 0;
+    for (size_t i = 0; i < kandydaci.size(); i++)
+    {
+        parametr = kandydaci[i];
+        double t = zmierz(f);
+        if (i == 0 || t < czas)
+        {
+            czas = t;
+            najlepszy = kandydaci[i];
+        }
+    }
+    parametr = najlepszy;
+}
+
+/**
+ * @brief Stroi kolejno liczbę wątków, ścieżkę i pas mnożenia oraz kafelek transpozycji jednej klasy.
+ * Mnożone są macierze o wartościach z przedziału [-5, 5], które mieszczą się w każdej ścieżce.
+ * Pomiary zmieniają kopię konfiguracji widoczną tylko dla bieżącego wątku; inne wątki
+ * widzą poprzednią konfigurację aż do opublikowania wyniku.
+ * @param klasa Klasa rozmiaru.
+ */
+static void stroj_klase(int klasa)
+{
+    int n = ROZMIARY_POMIAROWE[klasa];
+    konfiguracja_jader k;
+    {
+        lock_guard<mutex> l(blokada_konfiguracji);
+        k = konfiguracje[klasa];
+    }
+    proba = &k;
+    klasa_proby = klasa;
+    matrix a(n);
+    matrix b(n);
+    a.losuj();
+    b.losuj();
+    a - 5;
+    b - 4;
+    function<void(void)> mnozenie = [&] {
+        matrix c(a);
+        c * b;
+    };
+    vector<int> watki;
+    for (int t = 1; t < liczba_watkow(); t *= 2)
+    {
+        watki.push_back(t);
+    }
+    watki.push_back(0);
+    wybierz(k.watki, watki, mnozenie);
+    int sciezka = k.sciezka;
+    function<void(void)> mnozenie_sciezka = [&] {
+        k.sciezka = (sciezka_mnozenia)sciezka;
+        mnozenie();
+    };
+    wybierz(sciezka, { SCIEZKA_32, SCIEZKA_16, SCIEZKA_8 }, mnozenie_sciezka);
+    k.sciezka = (sciezka_mnozenia)sciezka;
+    if (k.sciezka != SCIEZKA_32)
+    {
+        wybierz(k.pas_mnozenia, { 16, 32, 64, 128, 256 }, mnozenie);
+    }
+    matrix t(n);
+    t.losuj();
+    wybierz(k.kafelek_transpozycji, { 8, 16, 32, 64, 128 }, [&] { t.dowroc(); });
+    proba = nullptr;
+    lock_guard<mutex> l(blokada_konfiguracji);
+    konfiguracje[klasa] = k;
+}
+
+/**
+ * @brief Stroi wszystkie klasy rozmiaru (wywoływana pod blokadą).
+ */
+static void stroj_wszystkie(void)
+{
+    for (int k = 0; k < LICZBA_KLAS_ROZMIARU; k++)
+    {
+        stroj_klase(k);
+    }
+}
+
+/**
+ * @brief Zwraca konfigurację jąder dla macierzy n x n.
+ * Przy pierwszym wywołaniu po wlacz_strojenie wczytuje plik podręczny lub stroi parametry.
+ * Wątek, który nie może korzystać z puli (wątek puli lub harmonogramu), dostaje bieżące
+ * wartości bez strojenia, bo jego pomiary nie odpowiadałyby pracy równoległej.
+ * Zwracana jest kopia, więc operacja widzi spójną konfigurację, nawet gdy inny wątek ją zmienia.
+ * @param n Rozmiar macierzy.
+ * @return Konfiguracja klasy rozmiaru n.
+ */
+konfiguracja_jader konfiguracja(int n)
+{
+    int klasa = klasa_rozmiaru(n);
+    if (proba != nullptr)
+    {
+        if (klasa == klasa_proby)
+        {
+            return *proba;
+        }
+    }
+    else if (do_strojenia.load(memory_order_acquire) && rownoleglosc_watku())
+    {
+        lock_guard<mutex> l(blokada);
+        if (do_strojenia.load(memory_order_relaxed))
+        {
+            if (!wczytaj(plik_podreczny))
+            {
+                stroj_wszystkie();
+                zapisz(plik_podreczny);
+            }
+            do_strojenia.store(false, memory_order_release);
+        }
+    }
+    lock_guard<mutex> l(blokada_konfiguracji);
+    return konfiguracje[klasa];
+}
+
+/**
+ * @brief Ustawia konfigurację klasy rozmiaru.
+ * Operacje już rozpoczęte dokańczają pracę z wcześniej pobraną kopią.
+ * @param klasa Klasa rozmiaru.
+ * @param k Konfiguracja.
+ */
+void ustaw_konfiguracje(int klasa, const konfiguracja_jader& k)
+{
+    if (klasa < 0 || klasa >= LICZBA_KLAS_ROZMIARU)
+    {
+        cout << "Nieznana klasa rozmiaru" << endl;
+        return;
+    }
+    lock_guard<mutex> l(blokada_konfiguracji);
+    konfiguracje[klasa] = k;
+}
+
+/**
+ * @brief Włącza strojenie przy pierwszym użyciu z zapamiętywaniem wyników w pliku.
+ * @param plik Ścieżka pliku podręcznego.
+ */
+void wlacz_strojenie(const string& plik)
+{
+    lock_guard<mutex> l(blokada);
+    plik_podreczny = plik;
+    do_strojenia.store(true, memory_order_release);
+}
+
+/**
+ * @brief Natychmiast stroi parametry wszystkich klas rozmiaru i zapisuje je w pliku.
+ * Pomiary trwają zwykle kilkaset milisekund. Nie należy wywoływać równocześnie z operacjami na macierzach.
+ * @param plik Ścieżka pliku podręcznego (pusta - bez zapisu).
+ * @return false jeśli nie udało się zapisać pliku lub bieżący wątek nie może korzystać z puli.
+ */
+bool stroj(const string& plik)
+{
+    if (!rownoleglosc_watku())
+    {
+        cout << "Strojenie wymaga watku, ktory moze korzystac z puli" << endl;
+        return false;
+    }
+    lock_guard<mutex> l(blokada);
+    stroj_wszystkie();
+    do_strojenia.store(false, memory_order_release);
+    return plik.empty() || zapisz(plik);
+}
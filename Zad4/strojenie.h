@@ -0,0 +1,84 @@
+#pragma once
+#include <string>
+using namespace std;
+
+/**
+ * @file strojenie.h
+ * @brief Parametry jder macierzowych dobierane pomiarami na biecym procesorze.
+ *
+ * Kada klasa rozmiaru macierzy ma wasn konfiguracj. Domylne wartoci s stae;
+ * po wlacz_strojenie pierwsze uycie konfiguracji wczytuje j z pliku podrcznego, a gdy
+ * brak w nim wpisu dla biecego procesora, wykonuje krtkie pomiary i zapisuje wynik.
+ * Wpisy rnych procesorw mog wspistnie w jednym pliku.
+ */
+
+/**
+ * @brief Liczba klas rozmiaru macierzy.
+ */
+const int LICZBA_KLAS_ROZMIARU = 3;
+
+/**
+ * @brief Najwszy typ elementw, do ktrego mnoenie moe pakowa czynniki.
+ */
+enum sciezka_mnozenia {
+    SCIEZKA_32, ///< Zawsze mnoenie 32-bitowe.
+    SCIEZKA_16, ///< Pakowanie do int16_t, gdy wartoci si mieszcz.
+    SCIEZKA_8   ///< Pakowanie do uint8_t x int8_t, a w drugiej kolejnoci do int16_t.
+};
+
+/**
+ * @struct konfiguracja_jader
+ * @brief Parametry jder dla jednej klasy rozmiaru.
+ */
+struct konfiguracja_jader {
+    int pas_mnozenia; ///< Szeroko pasa kolumn w mnoeniu wskimi typami.
+    int kafelek_transpozycji; ///< Bok kafelka w dowroc.
+    int watki; ///< Najwiksza liczba wtkw (0 - caa pula).
+    sciezka_mnozenia sciezka; ///< Najwsza dozwolona cieka mnoenia.
+};
+
+/**
+ * @brief Zwraca klas rozmiaru macierzy n x n.
+ * @param n Rozmiar macierzy.
+ * @return 0 dla n < 128, 1 dla n < 512, 2 dla wikszych.
+ */
+int klasa_rozmiaru(int n);
+
+/**
+ * @brief Zwraca konfiguracj jder dla macierzy n x n.
+ * Przy pierwszym wywoaniu po wlacz_strojenie wczytuje plik podrczny lub stroi parametry.
+ * Wtek, ktry nie moe korzysta z puli (wtek puli lub harmonogramu), dostaje biece
+ * wartoci bez strojenia, bo jego pomiary nie odpowiadayby pracy rwnolegej.
+ * Zwracana jest kopia, wic operacja widzi spjn konfiguracj, nawet gdy inny wtek j zmienia.
+ * @param n Rozmiar macierzy.
+ * @return Konfiguracja klasy rozmiaru n.
+ */
+konfiguracja_jader konfiguracja(int n);
+
+/**
+ * @brief Ustawia konfiguracj klasy rozmiaru.
+ * Operacje ju rozpoczte dokaczaj prac z wczeniej pobran kopi.
+ * @param klasa Klasa rozmiaru.
+ * @param k Konfiguracja.
+ */
+void ustaw_konfiguracje(int klasa, const konfiguracja_jader& k);
+
+/**
+ * @brief Wcza strojenie przy pierwszym uyciu z zapamitywaniem wynikw w pliku.
+ * @param plik cieka pliku podrcznego.
+ */
+void wlacz_strojenie(const string& plik);
+
+/**
+ * @brief Natychmiast stroi parametry wszystkich klas rozmiaru i zapisuje je w pliku.
+ * Pomiary trwaj zwykle kilkaset milisekund. Nie naley wywoywa rwnoczenie z operacjami na macierzach.
+ * @param plik cieka pliku podrcznego (pusta - bez zapisu).
+ * @return false jeli nie udao si zapisa pliku lub biecy wtek nie moe korzysta z puli.
+ */
+bool stroj(const string& plik);
+
+/**
+ * @brief Zwraca identyfikator procesora, pod ktrym zapisywane s wyniki strojenia.
+ * @return Nazwa procesora i liczba wtkw puli.
+ */
+string identyfikator_procesora(void);
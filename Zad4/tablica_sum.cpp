@@ -0,0 +1,263 @@
+#include "tablica_sum.h"
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+#include "watki.h"
+#include "metryki.h"
+using namespace std;
+
+/**
+ * @brief Buduje tablicę sum macierzy m.
+ * @param m Macierz.
+ */
+tablica_sum::tablica_sum(const matrix& m)
+{
+    n = 0;
+    sumy = nullptr;
+    przelicz(m);
+}
+
+/**
+ * @brief Konstruktor kopiujący.
+ * @param t Obiekt do skopiowania.
+ */
+tablica_sum::tablica_sum(const tablica_sum& t)
+{
+    n = t.n;
+    size_t d = (size_t)(n + 1) * (n + 1);
+    sumy = new long long[d];
+    memcpy(sumy, t.sumy, d * sizeof(long long));
+    zmiany = t.zmiany;
+}
+
+/**
+ * @brief Operator przypisania.
+ * @param t Obiekt do skopiowania.
+ * @return Referencja do obiektu.
+ */
+tablica_sum& tablica_sum::operator=(const tablica_sum& t)
+{
+    if (this != &t)
+    {
+        delete[] sumy;
+        n = t.n;
+        size_t d = (size_t)(n + 1) * (n + 1);
+        sumy = new long long[d];
+        memcpy(sumy, t.sumy, d * sizeof(long long));
+        zmiany = t.zmiany;
+    }
+    return *this;
+}
+
+/**
+ * @brief Destruktor.
+ */
+tablica_sum::~tablica_sum(void)
+{
+    delete[] sumy;
+}
+
+/**
+ * @brief Buduje tablicę od nowa dla macierzy m (także o innym rozmiarze).
+ * Najpierw każdy wiersz jest sumowany narastająco (wiersze równolegle), potem wiersze
+ * są dodawane narastająco pasami kolumn (pasy równolegle, pętla wektoryzowana).
+ * @param m Macierz.
+ */
+void tablica_sum::przelicz(const matrix& m)
+{
+    int nowe = m.dlug == nullptr ? 0 : *m.dlug;
+    MIERZ_OPERACJE(OP_SUMY, (long long)nowe * nowe * (sizeof(int) + 2 * sizeof(long long)));
+    if (sumy == nullptr || nowe != n)
+    {
+        delete[] sumy;
+        n = nowe;
+        sumy = new long long[(size_t)(n + 1) * (n + 1)];
+    }
+    zmiany.clear();
+    long long* zera = wiersz_sum(0);
+    for (int j = 0; j <= n; j++)
+    {
+        zera[j] = 0;
+    }
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int i = poczatek; i < koniec; i++)
+        {
+            const int* w = m.mac[i];
+            long long* s = wiersz_sum(i + 1);
+            long long suma = 0;
+            s[0] = 0;
+            for (int j = 0; j < n; j++)
+            {
+                suma += w[j];
+                s[j + 1] = suma;
+            }
+        }
+    });
+    // Pasy kolumn są niezależne, a w obrębie pasa wiersz jest dodawany do poprzedniego w całości.
+    rownolegle(n + 1, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int i = 1; i <= n; i++)
+        {
+            const long long* g = wiersz_sum(i - 1);
+            long long* s = wiersz_sum(i);
+            for (int j = poczatek; j < koniec; j++)
+            {
+                s[j] += g[j];
+            }
+        }
+    });
+}
+
+/**
+ * @brief Dodaje wektor do wierszy tablicy sum [od, az) (bloki wierszy równolegle).
+ * @param od Pierwszy wiersz.
+ * @param az Wiersz za ostatnim.
+ * @param kolumny Wektor n + 1 wartości.
+ */
+void tablica_sum::dodaj_do_wierszy(int od, int az, const long long* kolumny)
+{
+    rownolegle(az - od, (long long)(az - od) * (n + 1), [&](int blok, int poczatek, int koniec) {
+        for (int i = od + poczatek; i < od + koniec; i++)
+        {
+            long long* s = wiersz_sum(i);
+            for (int j = 0; j <= n; j++)
+            {
+                s[j] += kolumny[j];
+            }
+        }
+    });
+}
+
+/**
+ * @brief Wprowadza oczekujące zmiany do tablicy sum.
+ * Zmiany są sortowane według wierszy; wiersze tablicy między kolejnymi wierszami zmian
+ * dostają ten sam wektor sum narastających różnic, więc koszt to O(k * n + n * (n - x_min)).
+ */
+void tablica_sum::scal(void)
+{
+    if (zmiany.empty())
+    {
+        return;
+    }
+    sort(zmiany.begin(), zmiany.end(), [](const zmiana& a, const zmiana& b) { return a.x < b.x; });
+    MIERZ_OPERACJE(OP_SUMY, (long long)(n - zmiany.front().x) * (n + 1) * 2 * sizeof(long long));
+    vector<long long> punktowe(n + 1, 0);
+    vector<long long> kolumny(n + 1, 0);
+    size_t k = 0;
+    while (k < zmiany.size())
+    {
+        int x = zmiany[k].x;
+        for (; k < zmiany.size() && zmiany[k].x == x; k++)
+        {
+            punktowe[zmiany[k].y + 1] += zmiany[k].roznica;
+        }
+        long long suma = 0;
+        for (int j = 0; j <= n; j++)
+        {
+            suma += punktowe[j];
+            kolumny[j] = suma;
+        }
+        int az = k < zmiany.size() ? zmiany[k].x + 1 : n + 1;
+        dodaj_do_wierszy(x + 1, az, kolumny.data());
+    }
+    zmiany.clear();
+}
+
+/**
+ * @brief Zwraca sumę prostokątnego bloku macierzy.
+ * @param x Pierwszy wiersz bloku.
+ * @param y Pierwsza kolumna bloku.
+ * @param wys Liczba wierszy bloku.
+ * @param szer Liczba kolumn bloku.
+ * @return Suma elementów bloku (0 dla bloku spoza macierzy).
+ */
+long long tablica_sum::suma(int x, int y, int wys, int szer) const
+{
+    if (x < 0 || y < 0 || wys < 0 || szer < 0 || x > n - wys || y > n - szer)
+    {
+        cout << "Blok wykracza poza macierz" << endl;
+        return 0;
+    }
+    int x2 = x + wys;
+    int y2 = y + szer;
+    const long long* g = wiersz_sum(x);
+    const long long* d = wiersz_sum(x2);
+    long long wynik = d[y2] - d[y] - g[y2] + g[y];
+    for (const zmiana& z : zmiany)
+    {
+        if (z.x >= x && z.x < x2 && z.y >= y && z.y < y2)
+        {
+            wynik += z.roznica;
+        }
+    }
+    return wynik;
+}
+
+/**
+ * @brief Zwraca wartość elementu odtworzoną z tablicy.
+ * @param x Wiersz.
+ * @param y Kolumna.
+ * @return Wartość elementu.
+ */
+int tablica_sum::wartosc(int x, int y) const
+{
+    return (int)suma(x, y, 1, 1);
+}
+
+/**
+ * @brief Uwzględnia zmianę elementu macierzy (jak matrix::wstaw).
+ * Zmiana trafia na listę oczekujących; po ZMIANY_DO_SCALENIA zmianach lista jest wprowadzana do tablicy.
+ * @param x Wiersz.
+ * @param y Kolumna.
+ * @param wartosc Nowa wartość elementu.
+ */
+void tablica_sum::wstaw(int x, int y, int wartosc)
+{
+    if (x < 0 || y < 0 || x >= n || y >= n)
+    {
+        cout << "Indeks poza zakresem macierzy" << endl;
+        return;
+    }
+    long long roznica = (long long)wartosc - this->wartosc(x, y);
+    if (roznica == 0)
+    {
+        return;
+    }
+    zmiany.push_back({ x, y, roznica });
+    if ((int)zmiany.size() >= ZMIANY_DO_SCALENIA)
+    {
+        scal();
+    }
+}
+
+/**
+ * @brief Uwzględnia zmianę całego wiersza macierzy (jak matrix::wiersz).
+ * Wiersze tablicy od x + 1 w dół dostają sumy narastające różnic, w czasie O(n * (n - x)).
+ * @param x Numer wiersza.
+ * @param t Nowe wartości wiersza (n wartości).
+ */
+void tablica_sum::wiersz(int x, span<const int> t)
+{
+    if (x < 0 || x >= n)
+    {
+        cout << "Indeks poza zakresem macierzy" << endl;
+        return;
+    }
+    if ((int)t.size() < n)
+    {
+        cout << "Bufor jest za krotki" << endl;
+        return;
+    }
+    scal();
+    MIERZ_OPERACJE(OP_SUMY, (long long)(n - x) * (n + 1) * 2 * sizeof(long long));
+    const long long* g = wiersz_sum(x);
+    const long long* d = wiersz_sum(x + 1);
+    vector<long long> kolumny(n + 1);
+    long long suma = 0;
+    kolumny[0] = 0;
+    for (int j = 0; j < n; j++)
+    {
+        suma += (long long)t[j] - (d[j + 1] - d[j] - g[j + 1] + g[j]);
+        kolumny[j + 1] = suma;
+    }
+    dodaj_do_wierszy(x + 1, n + 1, kolumny.data());
+}
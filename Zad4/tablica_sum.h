@@ -0,0 +1,131 @@
+#pragma once
+#include <span>
+#include <vector>
+#include "matrix.h"
+using namespace std;
+
+/**
+ * @file tablica_sum.h
+ * @brief Tablica sum prefiksowych (summed-area table) z zapytaniami o sum prostokta w czasie O(1).
+ */
+
+/**
+ * @brief Liczba zmian pojedynczych elementw przechowywanych osobno przed wprowadzeniem ich do tablicy.
+ */
+const int ZMIANY_DO_SCALENIA = 64;
+
+/**
+ * @class tablica_sum
+ * @brief Sumy prefiksowe S[i][j] = suma elementw [0, i) x [0, j) macierzy, w liczbach 64-bitowych.
+ *
+ * Suma dowolnego prostokta to cztery odczyty tablicy. Zmiany pojedynczych elementw s
+ * zapisywane na licie i doliczane do wyniku zapytania, a po ZMIANY_DO_SCALENIA zmianach
+ * wprowadzane do tablicy jednym przebiegiem, wic zapytanie kosztuje co najwyej
+ * O(ZMIANY_DO_SCALENIA) niezalenie od rozmiaru prostokta.
+ */
+class tablica_sum {
+private:
+    /**
+     * @struct zmiana
+     * @brief Zmiana pojedynczego elementu oczekujca na wprowadzenie do tablicy.
+     */
+    struct zmiana {
+        int x; ///< Wiersz.
+        int y; ///< Kolumna.
+        long long roznica; ///< Nowa warto minus poprzednia.
+    };
+
+    int n; ///< Rozmiar macierzy.
+    long long* sumy; ///< Tablica (n + 1) x (n + 1) wierszami; wiersz i kolumna 0 s zerowe.
+    vector<zmiana> zmiany; ///< Zmiany oczekujce na wprowadzenie.
+
+    /**
+     * @brief Zwraca wskanik na wiersz i tablicy sum.
+     * @param i Numer wiersza (0..n).
+     * @return Wskanik na n + 1 sum.
+     */
+    long long* wiersz_sum(int i) const
+    {
+        return sumy + (size_t)i * (n + 1);
+    }
+
+    /**
+     * @brief Dodaje wektor do wierszy tablicy sum [od, az) (bloki wierszy rwnolegle).
+     * @param od Pierwszy wiersz.
+     * @param az Wiersz za ostatnim.
+     * @param kolumny Wektor n + 1 wartoci.
+     */
+    void dodaj_do_wierszy(int od, int az, const long long* kolumny);
+
+    /**
+     * @brief Wprowadza oczekujce zmiany do tablicy sum.
+     */
+    void scal(void);
+
+public:
+    /**
+     * @brief Buduje tablic sum macierzy m.
+     * @param m Macierz.
+     */
+    tablica_sum(const matrix& m);
+
+    /**
+     * @brief Konstruktor kopiujcy.
+     * @param t Obiekt do skopiowania.
+     */
+    tablica_sum(const tablica_sum& t);
+
+    /**
+     * @brief Operator przypisania.
+     * @param t Obiekt do skopiowania.
+     * @return Referencja do obiektu.
+     */
+    tablica_sum& operator=(const tablica_sum& t);
+
+    /**
+     * @brief Destruktor.
+     */
+    ~tablica_sum(void);
+
+    /**
+     * @brief Buduje tablic od nowa dla macierzy m (take o innym rozmiarze).
+     * Najpierw kady wiersz jest sumowany narastajco (wiersze rwnolegle), potem wiersze
+     * s dodawane narastajco pasami kolumn (pasy rwnolegle, ptla wektoryzowana).
+     * @param m Macierz.
+     */
+    void przelicz(const matrix& m);
+
+    /**
+     * @brief Zwraca sum prostoktnego bloku macierzy.
+     * @param x Pierwszy wiersz bloku.
+     * @param y Pierwsza kolumna bloku.
+     * @param wys Liczba wierszy bloku.
+     * @param szer Liczba kolumn bloku.
+     * @return Suma elementw bloku (0 dla bloku spoza macierzy).
+     */
+    long long suma(int x, int y, int wys, int szer) const;
+
+    /**
+     * @brief Zwraca warto elementu odtworzon z tablicy.
+     * @param x Wiersz.
+     * @param y Kolumna.
+     * @return Warto elementu.
+     */
+    int wartosc(int x, int y) const;
+
+    /**
+     * @brief Uwzgldnia zmian elementu macierzy (jak matrix::wstaw).
+     * @param x Wiersz.
+     * @param y Kolumna.
+     * @param wartosc Nowa warto elementu.
+     */
+    void wstaw(int x, int y, int wartosc);
+
+    /**
+     * @brief Uwzgldnia zmian caego wiersza macierzy (jak matrix::wiersz).
+     * Wiersze tablicy od x + 1 w d dostaj sumy narastajce rnic, w czasie O(n * (n - x)).
+     * @param x Numer wiersza.
+     * @param t Nowe wartoci wiersza (n wartoci).
+     */
+    void wiersz(int x, span<const int> t);
+};
@@ -0,0 +1,428 @@
+#include "trojkatna.h"
+#include <iostream>
+#include <ostream>
+#include <cstring>
+#include <vector>
+#include "watki.h"
+using namespace std;
+
+/**
+ * @brief Zwraca pierwszą przechowywaną kolumnę wiersza i.
+ * @param i Numer wiersza.
+ * @return Numer kolumny.
+ */
+int macierz_trojkatna::pierwsza(int i) const
+{
+    int d = przekatna == PRZEKATNA_OGOLNA ? 0 : 1;
+    return typ == DOLNY ? 0 : i + d;
+}
+
+/**
+ * @brief Zwraca kolumnę za ostatnią przechowywaną w wierszu i.
+ * @param i Numer wiersza.
+ * @return Numer kolumny.
+ */
+int macierz_trojkatna::koniec(int i) const
+{
+    int d = przekatna == PRZEKATNA_OGOLNA ? 0 : 1;
+    return typ == DOLNY ? i + 1 - d : n;
+}
+
+/**
+ * @brief Zwraca wskaźnik, pod którym leży kolumna pierwsza(i) wiersza i.
+ * @param i Numer wiersza.
+ * @return Wskaźnik na upakowany wiersz.
+ */
+int* macierz_trojkatna::wiersz(int i) const
+{
+    long long d = przekatna == PRZEKATNA_OGOLNA ? 0 : 1;
+    long long r = i;
+    if (typ == DOLNY)
+    {
+        return dane + (r * (r + 1) / 2 - d * r);
+    }
+    return dane + (r * n - r * (r - 1) / 2 - d * r);
+}
+
+/**
+ * @brief Zwraca wartość elementu przekątnej w wierszu i.
+ * @param i Numer wiersza.
+ * @return Element przekątnej.
+ */
+int macierz_trojkatna::element_przekatnej(int i) const
+{
+    if (przekatna == PRZEKATNA_ZEROWA)
+    {
+        return 0;
+    }
+    if (przekatna == PRZEKATNA_JEDNOSTKOWA)
+    {
+        return 1;
+    }
+    return wiersz(i)[i - pierwsza(i)];
+}
+
+/**
+ * @brief Tworzy macierz trójkątną o rozmiarze n x n wypełnioną wartością.
+ * @param n Rozmiar macierzy.
+ * @param typ Dolna lub górna.
+ * @param przekatna Rodzaj przekątnej.
+ * @param wartosc Wartość przechowywanych elementów.
+ */
+macierz_trojkatna::macierz_trojkatna(int n, trojkat typ, rodzaj_przekatnej przekatna, int wartosc)
+{
+    this->n = n;
+    this->typ = typ;
+    this->przekatna = przekatna;
+    long long ile = liczba_elementow();
+    dane = new int[ile > 0 ? ile : 1];
+    for (long long i = 0; i < ile; i++)
+    {
+        dane[i] = wartosc;
+    }
+}
+
+/**
+ * @brief Tworzy macierz trójkątną z odpowiedniej połowy macierzy m.
+ * @param m Macierz źródłowa.
+ * @param typ Dolna lub górna.
+ * @param przekatna Rodzaj przekątnej.
+ */
+macierz_trojkatna::macierz_trojkatna(matrix& m, trojkat typ, rodzaj_przekatnej przekatna)
+{
+    this->n = *m.dlug;
+    this->typ = typ;
+    this->przekatna = przekatna;
+    long long ile = liczba_elementow();
+    dane = new int[ile > 0 ? ile : 1];
+    for (int i = 0; i < n; i++)
+    {
+        int p = pierwsza(i);
+        memcpy(wiersz(i), m.mac[i] + p, (koniec(i) - p) * sizeof(int));
+    }
+}
+
+/**
+ * @brief Konstruktor kopiujący.
+ * @param t Obiekt do skopiowania.
+ */
+macierz_trojkatna::macierz_trojkatna(const macierz_trojkatna& t)
+{
+    n = t.n;
+    typ = t.typ;
+    przekatna = t.przekatna;
+    long long ile = liczba_elementow();
+    dane = new int[ile > 0 ? ile : 1];
+    memcpy(dane, t.dane, ile * sizeof(int));
+}
+
+/**
+ * @brief Operator przypisania.
+ * @param t Obiekt do skopiowania.
+ * @return Referencja do obiektu.
+ */
+macierz_trojkatna& macierz_trojkatna::operator=(const macierz_trojkatna& t)
+{
+    if (this != &t)
+    {
+        delete[] dane;
+        n = t.n;
+        typ = t.typ;
+        przekatna = t.przekatna;
+        long long ile = liczba_elementow();
+        dane = new int[ile > 0 ? ile : 1];
+        memcpy(dane, t.dane, ile * sizeof(int));
+    }
+    return *this;
+}
+
+/**
+ * @brief Destruktor.
+ */
+macierz_trojkatna::~macierz_trojkatna(void)
+{
+    delete[] dane;
+}
+
+/**
+ * @brief Zwraca rozmiar macierzy.
+ * @return Rozmiar n.
+ */
+int macierz_trojkatna::rozmiar(void) const
+{
+    return n;
+}
+
+/**
+ * @brief Zwraca liczbę przechowywanych elementów.
+ * @return Liczba elementów upakowanej części.
+ */
+long long macierz_trojkatna::liczba_elementow(void) const
+{
+    long long d = przekatna == PRZEKATNA_OGOLNA ? 0 : 1;
+    return (long long)n * (n + 1) / 2 - d * n;
+}
+
+/**
+ * @brief Zwraca wartość z określonej pozycji (także z zerowej połowy).
+ * @param x Wiersz.
+ * @param y Kolumna.
+ * @return Wartość elementu.
+ */
+int macierz_trojkatna::pokaz(int x, int y) const
+{
+    if (x == y)
+    {
+        return element_przekatnej(x);
+    }
+    int p = pierwsza(x);
+    if (y >= p && y < koniec(x))
+    {
+        return wiersz(x)[y - p];
+    }
+    return 0;
+}
+
+/**
+ * @brief Wstawia wartość w przechowywanej części macierzy.
+ * @param x Wiersz.
+ * @param y Kolumna.
+ * @param wartosc Wartość do wstawienia.
+ * @return Referencja do obiektu.
+ */
+macierz_trojkatna& macierz_trojkatna::wstaw(int x, int y, int wartosc)
+{
+    int p = pierwsza(x);
+    if (y < p || y >= koniec(x))
+    {
+        cout << "Pozycja poza przechowywana czescia macierzy" << endl;
+        return *this;
+    }
+    wiersz(x)[y - p] = wartosc;
+    return *this;
+}
+
+/**
+ * @brief Zapisuje pełną postać macierzy do m (m musi mieć rozmiar n).
+ * @param m Macierz docelowa.
+ */
+void macierz_trojkatna::rozpakuj(matrix& m) const
+{
+    if (*m.dlug != n)
+    {
+        cout << "Macierze posiadaja rozne dlugosci" << endl;
+        return;
+    }
+    m.odlacz();
+    for (int i = 0; i < n; i++)
+    {
+        int* w = m.mac[i];
+        int p = pierwsza(i);
+        int k = koniec(i);
+        for (int j = 0; j < n; j++)
+        {
+            w[j] = 0;
+        }
+        memcpy(w + p, wiersz(i), (k - p) * sizeof(int));
+        w[i] = element_przekatnej(i);
+    }
+}
+
+/**
+ * @brief Mnożenie trójkątne z lewej strony: b = this * b.
+ * Wiersz i wyniku zależy tylko od wierszy b po tej samej stronie przekątnej, więc
+ * przechodząc wiersze od strony przeciwnej można nadpisywać b w miejscu. Kolumny b
+ * są niezależne i dzielone między wątki blokami.
+ * @param b Macierz mnożona, nadpisywana wynikiem.
+ */
+void macierz_trojkatna::mnoz_z_lewej(matrix& b) const
+{
+    if (*b.dlug != n)
+    {
+        cout << "Macierze posiadaja rozne dlugosci" << endl;
+        return;
+    }
+    b.odlacz();
+    rownolegle(n, (long long)n * n * n / 2, [&](int blok, int c0, int c1) {
+        int szer = c1 - c0;
+        vector<unsigned int> suma(szer);
+        for (int s = 0; s < n; s++)
+        {
+            int i = typ == DOLNY ? n - 1 - s : s;
+            int p = pierwsza(i);
+            int k = koniec(i);
+            const int* t = wiersz(i);
+            unsigned int d = przekatna == PRZEKATNA_JEDNOSTKOWA ? 1 : 0;
+            const int* bi = b.mac[i] + c0;
+            for (int j = 0; j < szer; j++)
+            {
+                suma[j] = d * (unsigned int)bi[j];
+            }
+            for (int q = p; q < k; q++)
+            {
+                unsigned int tq = t[q - p];
+                const int* bq = b.mac[q] + c0;
+                for (int j = 0; j < szer; j++)
+                {
+                    suma[j] += tq * (unsigned int)bq[j];
+                }
+            }
+            int* wi = b.mac[i] + c0;
+            for (int j = 0; j < szer; j++)
+            {
+                wi[j] = (int)suma[j];
+            }
+        }
+    });
+}
+
+/**
+ * @brief Mnożenie trójkątne z prawej strony: b = b * this.
+ * Każdy wiersz b jest mnożony niezależnie, a pętla wewnętrzna obejmuje tylko
+ * przechowywaną część wiersza macierzy trójkątnej.
+ * @param b Macierz mnożona, nadpisywana wynikiem.
+ */
+void macierz_trojkatna::mnoz_z_prawej(matrix& b) const
+{
+    if (*b.dlug != n)
+    {
+        cout << "Macierze posiadaja rozne dlugosci" << endl;
+        return;
+    }
+    b.odlacz();
+    rownolegle(n, (long long)n * n * n / 2, [&](int blok, int poczatek, int koniec_bloku) {
+        vector<unsigned int> suma(n);
+        for (int i = poczatek; i < koniec_bloku; i++)
+        {
+            int* bi = b.mac[i];
+            for (int j = 0; j < n; j++)
+            {
+                suma[j] = 0;
+            }
+            for (int q = 0; q < n; q++)
+            {
+                unsigned int bq = bi[q];
+                int p = pierwsza(q);
+                int k = koniec(q);
+                const int* t = wiersz(q);
+                for (int j = p; j < k; j++)
+                {
+                    suma[j] += bq * (unsigned int)t[j - p];
+                }
+                if (przekatna == PRZEKATNA_JEDNOSTKOWA)
+                {
+                    suma[q] += bq;
+                }
+            }
+            for (int j = 0; j < n; j++)
+            {
+                bi[j] = (int)suma[j];
+            }
+        }
+    });
+}
+
+/**
+ * @brief Rozwiązuje układ this * x = b, nadpisując b rozwiązaniem x.
+ * Sumy są liczone dokładnie (suma_szeroka); rozwiązanie powstaje w kopii roboczej, więc przy
+ * niepowodzeniu b pozostaje bez zmian.
+ * Podstawianie w przód (macierz dolna) lub wstecz (górna) wykonywane jest w miejscu,
+ * niezależnie dla bloków kolumn b.
+ * @param b Prawa strona układu, nadpisywana rozwiązaniem.
+ * @return false jeśli macierz jest osobliwa, rozwiązanie nie jest całkowite lub nie mieści się w int.
+ */
+bool macierz_trojkatna::rozwiaz(matrix& b) const
+{
+    if (*b.dlug != n)
+    {
+        cout << "Macierze posiadaja rozne dlugosci" << endl;
+        return false;
+    }
+    for (int i = 0; i < n; i++)
+    {
+        if (element_przekatnej(i) == 0)
+        {
+            cout << "Macierz trojkatna jest osobliwa" << endl;
+            return false;
+        }
+    }
+    matrix x(b);
+    x.odlacz();
+    vector<char> niecalkowite(liczba_blokow(n));
+    vector<char> poza_zakresem(liczba_blokow(n));
+    rownolegle(n, (long long)n * n * n / 2, [&](int blok, int c0, int c1) {
+        int szer = c1 - c0;
+        vector<suma_szeroka> suma(szer);
+        for (int s = 0; s < n; s++)
+        {
+            int i = typ == DOLNY ? s : n - 1 - s;
+            int p = pierwsza(i);
+            int k = koniec(i);
+            const int* t = wiersz(i);
+            const int* bi = x.mac[i] + c0;
+            for (int j = 0; j < szer; j++)
+            {
+                suma[j] = suma_szeroka();
+                suma[j].dodaj(bi[j]);
+            }
+            for (int q = p; q < k; q++)
+            {
+                if (q == i)
+                {
+                    continue;
+                }
+                long long tq = t[q - p];
+                const int* xq = x.mac[q] + c0;
+                for (int j = 0; j < szer; j++)
+                {
+                    suma[j].dodaj(-(tq * xq[j]));
+                }
+            }
+            int d = element_przekatnej(i);
+            int* wi = x.mac[i] + c0;
+            for (int j = 0; j < szer; j++)
+            {
+                // Suma nasycona do granicy long long daje iloraz spoza int dla każdego d.
+                long long v = suma[j].wartosc();
+                long long iloraz = v == LLONG_MIN || v == LLONG_MAX ? LLONG_MAX : v / d;
+                niecalkowite[blok] |= iloraz != LLONG_MAX && v % d != 0;
+                poza_zakresem[blok] |= iloraz < INT_MIN || iloraz > INT_MAX;
+                wi[j] = (int)iloraz;
+            }
+        }
+    });
+    for (size_t i = 0; i < niecalkowite.size(); i++)
+    {
+        if (niecalkowite[i])
+        {
+            cout << "Rozwiazanie nie jest calkowite" << endl;
+            return false;
+        }
+        if (poza_zakresem[i])
+        {
+            cout << "Rozwiazanie nie miesci sie w int" << endl;
+            return false;
+        }
+    }
+    b = x;
+    return true;
+}
+
+/**
+ * @brief Operator wyjścia strumienia dla macierzy trójkątnej.
+ * @param o Strumień wyjściowy.
+ * @param t Obiekt do wyświetlenia.
+ * @return Strumień wyjściowy.
+ */
+ostream& operator<<(ostream& o, const macierz_trojkatna& t)
+{
+    for (int i = 0; i < t.n; i++)
+    {
+        for (int j = 0; j < t.n; j++)
+        {
+            o << t.pokaz(i, j) << " ";
+        }
+        o << endl;
+    }
+    return o;
+}
@@ -0,0 +1,167 @@
+#pragma once
+#include <iostream>
+#include <ostream>
+#include "matrix.h"
+using namespace std;
+
+/**
+ * @brief Pooenie niezerowej czci macierzy trjktnej.
+ */
+enum trojkat {
+    DOLNY, ///< Elementy na i pod przektn.
+    GORNY  ///< Elementy na i nad przektn.
+};
+
+/**
+ * @brief Rodzaj przektnej macierzy trjktnej.
+ */
+enum rodzaj_przekatnej {
+    PRZEKATNA_OGOLNA,      ///< Przektna przechowywana jak pozostae elementy.
+    PRZEKATNA_ZEROWA,      ///< Macierz cile trjktna, przektna rwna 0 i nieprzechowywana.
+    PRZEKATNA_JEDNOSTKOWA  ///< Przektna rwna 1 i nieprzechowywana.
+};
+
+/**
+ * @class macierz_trojkatna
+ * @brief Macierz trjktna przechowywana w postaci upakowanej (tylko niezerowa poowa).
+ *
+ * Wiersz i macierzy dolnej zawiera kolumny [0, i], a grnej [i, n - 1]; przy przektnej
+ * zerowej lub jednostkowej przektna nie jest przechowywana. Zajmuje okoo n * n / 2
+ * liczb, a mnoenie i rozwizywanie ukadw pomijaj zerow poow.
+ */
+class macierz_trojkatna {
+private:
+    int n; ///< Rozmiar macierzy.
+    trojkat typ; ///< Dolna lub grna.
+    rodzaj_przekatnej przekatna; ///< Rodzaj przektnej.
+    int* dane; ///< Upakowane wiersze niezerowej czci.
+
+    /**
+     * @brief Zwraca pierwsz przechowywan kolumn wiersza i.
+     * @param i Numer wiersza.
+     * @return Numer kolumny.
+     */
+    int pierwsza(int i) const;
+
+    /**
+     * @brief Zwraca kolumn za ostatni przechowywan w wierszu i.
+     * @param i Numer wiersza.
+     * @return Numer kolumny.
+     */
+    int koniec(int i) const;
+
+    /**
+     * @brief Zwraca wskanik, pod ktrym ley kolumna pierwsza(i) wiersza i.
+     * @param i Numer wiersza.
+     * @return Wskanik na upakowany wiersz.
+     */
+    int* wiersz(int i) const;
+
+    /**
+     * @brief Zwraca warto elementu przektnej w wierszu i.
+     * @param i Numer wiersza.
+     * @return Element przektnej.
+     */
+    int element_przekatnej(int i) const;
+
+public:
+    /**
+     * @brief Tworzy macierz trjktn o rozmiarze n x n wypenion wartoci.
+     * Dla DOLNY i PRZEKATNA_ZEROWA z wartoci 1 odpowiada matrix::pod_przekatna.
+     * @param n Rozmiar macierzy.
+     * @param typ Dolna lub grna.
+     * @param przekatna Rodzaj przektnej.
+     * @param wartosc Warto przechowywanych elementw.
+     */
+    macierz_trojkatna(int n, trojkat typ, rodzaj_przekatnej przekatna, int wartosc);
+
+    /**
+     * @brief Tworzy macierz trjktn z odpowiedniej poowy macierzy m.
+     * @param m Macierz rdowa.
+     * @param typ Dolna lub grna.
+     * @param przekatna Rodzaj przektnej.
+     */
+    macierz_trojkatna(matrix& m, trojkat typ, rodzaj_przekatnej przekatna);
+
+    /**
+     * @brief Konstruktor kopiujcy.
+     * @param t Obiekt do skopiowania.
+     */
+    macierz_trojkatna(const macierz_trojkatna& t);
+
+    /**
+     * @brief Operator przypisania.
+     * @param t Obiekt do skopiowania.
+     * @return Referencja do obiektu.
+     */
+    macierz_trojkatna& operator=(const macierz_trojkatna& t);
+
+    /**
+     * @brief Destruktor.
+     */
+    ~macierz_trojkatna(void);
+
+    /**
+     * @brief Zwraca rozmiar macierzy.
+     * @return Rozmiar n.
+     */
+    int rozmiar(void) const;
+
+    /**
+     * @brief Zwraca liczb przechowywanych elementw.
+     * @return Liczba elementw upakowanej czci.
+     */
+    long long liczba_elementow(void) const;
+
+    /**
+     * @brief Zwraca warto z okrelonej pozycji (take z zerowej poowy).
+     * @param x Wiersz.
+     * @param y Kolumna.
+     * @return Warto elementu.
+     */
+    int pokaz(int x, int y) const;
+
+    /**
+     * @brief Wstawia warto w przechowywanej czci macierzy.
+     * @param x Wiersz.
+     * @param y Kolumna.
+     * @param wartosc Warto do wstawienia.
+     * @return Referencja do obiektu.
+     */
+    macierz_trojkatna& wstaw(int x, int y, int wartosc);
+
+    /**
+     * @brief Zapisuje pen posta macierzy do m (m musi mie rozmiar n).
+     * @param m Macierz docelowa.
+     */
+    void rozpakuj(matrix& m) const;
+
+    /**
+     * @brief Mnoenie trjktne z lewej strony: b = this * b.
+     * @param b Macierz mnoona, nadpisywana wynikiem.
+     */
+    void mnoz_z_lewej(matrix& b) const;
+
+    /**
+     * @brief Mnoenie trjktne z prawej strony: b = b * this.
+     * @param b Macierz mnoona, nadpisywana wynikiem.
+     */
+    void mnoz_z_prawej(matrix& b) const;
+
+    /**
+     * @brief Rozwizuje ukad this * x = b, nadpisujc b rozwizaniem x.
+     * Sumy s liczone dokadnie (suma_szeroka); rozwizanie powstaje w kopii roboczej, wic przy
+     * niepowodzeniu b pozostaje bez zmian.
+     * @param b Prawa strona ukadu, nadpisywana rozwizaniem.
+     * @return false jeli macierz jest osobliwa, rozwizanie nie jest cakowite lub nie mieci si w int.
+     */
+    bool rozwiaz(matrix& b) const;
+
+    /**
+     * @brief Operator wyjcia strumienia dla macierzy trjktnej.
+     * @param o Strumie wyjciowy.
+     * @param t Obiekt do wywietlenia.
+     * @return Strumie wyjciowy.
+     */
+    friend ostream& operator<<(ostream& o, const macierz_trojkatna& t);
+};
@@ -0,0 +1,240 @@
+#include "watki.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+using namespace std;
+
+/**
+ * @brief Czy bieżący wątek wykonuje właśnie zadanie puli (chroni przed zakleszczeniem przy zagnieżdżeniu).
+ */
+static thread_local bool w_puli = false;
+
+/**
+ * @class pula_watkow
+ * @brief Stała pula wątków; wątek t wykonuje bloki t, t + T, t + 2T, ...
+ */
+class pula_watkow {
+private:
+    vector<thread> watki; ///< Wątki robocze (wątek 0 to wątek wywołujący).
+    mutex blokada_zadan; ///< Serializuje zlecenia z różnych wątków.
+    mutex blokada; ///< Chroni stan zlecenia.
+    condition_variable start; ///< Sygnalizuje nowe zlecenie.
+    condition_variable koniec; ///< Sygnalizuje zakończenie pracy wątków.
+    const function<void(int)>* zadanie = nullptr; ///< Bieżące zadanie wywoływane z numerem bloku.
+    int bloki = 0; ///< Liczba bloków bieżącego zlecenia.
+    int aktywne = 1; ///< Liczba wątków, między które dzielone jest bieżące zlecenie.
+    int pozostale = 0; ///< Liczba wątków roboczych, które jeszcze pracują.
+    unsigned long long pokolenie = 0; ///< Numer bieżącego zlecenia.
+    bool zamykanie = false; ///< Czy pula jest zamykana.
+
+    /**
+     * @brief Wykonuje bloki przypisane do wątku t (żadne, jeśli t nie należy do aktywnych).
+     * @param t Numer wątku.
+     */
+    void wykonaj_bloki(int t)
+    {
+        for (int b = t; b < bloki && t < aktywne; b += aktywne)
+        {
+            (*zadanie)(b);
+        }
+    }
+
+    /**
+     * @brief Pętla wątku roboczego.
+     * @param t Numer wątku.
+     */
+    void petla(int t)
+    {
+        w_puli = true;
+        unsigned long long widziane = 0;
+        while (true)
+        {
+            {
+                unique_lock<mutex> l(blokada);
+                start.wait(l, [&] { return zamykanie || pokolenie != widziane; });
+                if (zamykanie)
+                {
+                    return;
+                }
+                widziane = pokolenie;
+            }
+            wykonaj_bloki(t);
+            {
+                lock_guard<mutex> l(blokada);
+                pozostale--;
+            }
+            koniec.notify_one();
+        }
+    }
+
+public:
+    /**
+     * @brief Tworzy pulę o liczbie wątków równej liczbie procesorów logicznych.
+     */
+    pula_watkow(void)
+    {
+        int T = (int)thread::hardware_concurrency();
+        for (int t = 1; t < T; t++)
+        {
+            watki.push_back(thread(&pula_watkow::petla, this, t));
+        }
+    }
+
+    /**
+     * @brief Zatrzymuje i łączy wątki robocze.
+     */
+    ~pula_watkow(void)
+    {
+        {
+            lock_guard<mutex> l(blokada);
+            zamykanie = true;
+        }
+        start.notify_all();
+        for (size_t i = 0; i < watki.size(); i++)
+        {
+            watki[i].join();
+        }
+    }
+
+    /**
+     * @brief Zwraca liczbę wątków puli.
+     * @return Liczba wątków łącznie z wywołującym.
+     */
+    int rozmiar(void)
+    {
+        return (int)watki.size() + 1;
+    }
+
+    /**
+     * @brief Wykonuje zadanie dla bloków [0, liczba) i czeka na zakończenie.
+     * @param liczba Liczba bloków.
+     * @param z Zadanie wywoływane z numerem bloku.
+     * @param uzyte Liczba wątków wykonujących bloki (od 1 do rozmiar()).
+     */
+    void wykonaj(int liczba, const function<void(int)>& z, int uzyte)
+    {
+        lock_guard<mutex> zlecenie(blokada_zadan);
+        {
+            lock_guard<mutex> l(blokada);
+            zadanie = &z;
+            bloki = liczba;
+            aktywne = uzyte;
+            pozostale = (int)watki.size();
+            pokolenie++;
+        }
+        start.notify_all();
+        w_puli = true;
+        wykonaj_bloki(0);
+        w_puli = false;
+        unique_lock<mutex> l(blokada);
+        koniec.wait(l, [&] { return pozostale == 0; });
+    }
+};
+
+/**
+ * @brief Zwraca wspólną pulę wątków, tworzoną przy pierwszym użyciu.
+ * @return Referencja do puli.
+ */
+static pula_watkow& pula(void)
+{
+    static pula_watkow p;
+    return p;
+}
+
+/**
+ * @brief Zwraca liczbę wątków puli (łącznie z wątkiem wywołującym).
+ * @return Liczba wątków.
+ */
+int liczba_watkow(void)
+{
+    return pula().rozmiar();
+}
+
+/**
+ * @brief Zwraca liczbę bloków, na które dzielone jest n wierszy.
+ * @param n Liczba wierszy.
+ * @return Liczba bloków.
+ */
+int liczba_blokow(int n)
+{
+    return (n + WIERSZE_W_BLOKU - 1) / WIERSZE_W_BLOKU;
+}
+
+/**
+ * @brief Zwraca liczbę wątków do użycia przy podanym ograniczeniu.
+ * @param watki Ograniczenie (0 lub więcej niż rozmiar puli - cała pula).
+ * @return Liczba wątków od 1 do liczba_watkow().
+ */
+static int uzyte_watki(int watki)
+{
+    int T = liczba_watkow();
+    return watki <= 0 || watki > T ? T : watki;
+}
+
+/**
+ * @brief Wykonuje zadanie dla każdego bloku wierszy z przedziału [0, n).
+ * Poniżej progu pracy oraz przy wywołaniu z wnętrza puli bloki są przetwarzane szeregowo.
+ * @param n Liczba wierszy.
+ * @param praca Szacowana liczba operacji na elementach.
+ * @param zadanie Funkcja wywoływana jako zadanie(blok, poczatek, koniec).
+ * @param watki Największa liczba użytych wątków (0 - wszystkie wątki puli).
+ */
+void rownolegle(int n, long long praca, const function<void(int, int, int)>& zadanie, int watki)
+{
+    int bloki = liczba_blokow(n);
+    function<void(int)> blok = [&](int b) {
+        int poczatek = b * WIERSZE_W_BLOKU;
+        int koniec = poczatek + WIERSZE_W_BLOKU < n ? poczatek + WIERSZE_W_BLOKU : n;
+        zadanie(b, poczatek, koniec);
+    };
+    if (bloki <= 1 || praca < PROG_ROWNOLEGLOSCI || w_puli || uzyte_watki(watki) == 1)
+    {
+        for (int b = 0; b < bloki; b++)
+        {
+            blok(b);
+        }
+        return;
+    }
+    pula().wykonaj(bloki, blok, uzyte_watki(watki));
+}
+
+/**
+ * @brief Wykonuje k niezależnych zadań; zadanie i trafia do wątku i % T, gdzie T to liczba użytych wątków.
+ * Poniżej progu pracy oraz przy wywołaniu z wnętrza puli zadania są wykonywane szeregowo.
+ * @param k Liczba zadań.
+ * @param praca Szacowana łączna liczba operacji.
+ * @param zadanie Funkcja wywoływana jako zadanie(i) dla i z [0, k).
+ * @param watki Największa liczba użytych wątków (0 - wszystkie wątki puli).
+ */
+void rownolegle_zadania(int k, long long praca, const function<void(int)>& zadanie, int watki)
+{
+    if (k <= 1 || praca < PROG_ROWNOLEGLOSCI || w_puli || uzyte_watki(watki) == 1)
+    {
+        for (int i = 0; i < k; i++)
+        {
+            zadanie(i);
+        }
+        return;
+    }
+    pula().wykonaj(k, zadanie, uzyte_watki(watki));
+}
+
+/**
+ * @brief Wyłącza w bieżącym wątku dzielenie pracy między wątki puli.
+ * Wątki, które same wykonują niezależne zadania równolegle, przetwarzają wtedy bloki szeregowo
+ * zamiast czekać na wspólną pulę.
+ */
+void wylacz_rownoleglosc_watku(void)
+{
+    w_puli = true;
+}
+
+/**
+ * @brief Sprawdza, czy bieżący wątek może dzielić pracę między wątki puli.
+ * @return false w wątkach puli, w trakcie ich zadań oraz po wylacz_rownoleglosc_watku.
+ */
+bool rownoleglosc_watku(void)
+{
+    return !w_puli;
+}
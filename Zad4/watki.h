@@ -0,0 +1,69 @@
+#pragma once
+#include <functional>
+using namespace std;
+
+/**
+ * @file watki.h
+ * @brief Staa pula wtkw i rwnolege przetwarzanie macierzy blokami wierszy.
+ *
+ * Wiersze s dzielone na bloki o staej wielkoci, niezalenej od liczby wtkw,
+ * a blok b zawsze trafia do wtku b % T, gdzie T to liczba uytych wtkw. Wyniki
+ * czciowe zapisane w indeksie bloku i czone w kolejnoci blokw daj wic ten sam
+ * wynik przy kadym przebiegu.
+ */
+
+/**
+ * @brief Liczba wierszy w jednym bloku.
+ */
+const int WIERSZE_W_BLOKU = 32;
+
+/**
+ * @brief Minimalna liczba operacji na elementach, od ktrej praca jest rozdzielana midzy wtki.
+ */
+const long long PROG_ROWNOLEGLOSCI = 1 << 16;
+
+/**
+ * @brief Zwraca liczb wtkw puli (cznie z wtkiem wywoujcym).
+ * @return Liczba wtkw.
+ */
+int liczba_watkow(void);
+
+/**
+ * @brief Zwraca liczb blokw, na ktre dzielone jest n wierszy.
+ * @param n Liczba wierszy.
+ * @return Liczba blokw.
+ */
+int liczba_blokow(int n);
+
+/**
+ * @brief Wykonuje zadanie dla kadego bloku wierszy z przedziau [0, n).
+ * Poniej progu pracy oraz przy wywoaniu z wntrza puli bloki s przetwarzane szeregowo.
+ * @param n Liczba wierszy.
+ * @param praca Szacowana liczba operacji na elementach.
+ * @param zadanie Funkcja wywoywana jako zadanie(blok, poczatek, koniec).
+ * @param watki Najwiksza liczba uytych wtkw (0 - wszystkie wtki puli).
+ */
+void rownolegle(int n, long long praca, const function<void(int, int, int)>& zadanie, int watki = 0);
+
+/**
+ * @brief Wykonuje k niezalenych zada; zadanie i trafia do wtku i % T, gdzie T to liczba uytych wtkw.
+ * Poniej progu pracy oraz przy wywoaniu z wntrza puli zadania s wykonywane szeregowo.
+ * @param k Liczba zada.
+ * @param praca Szacowana czna liczba operacji.
+ * @param zadanie Funkcja wywoywana jako zadanie(i) dla i z [0, k).
+ * @param watki Najwiksza liczba uytych wtkw (0 - wszystkie wtki puli).
+ */
+void rownolegle_zadania(int k, long long praca, const function<void(int)>& zadanie, int watki = 0);
+
+/**
+ * @brief Wycza w biecym wtku dzielenie pracy midzy wtki puli.
+ * Wtki, ktre same wykonuj niezalene zadania rwnolegle, przetwarzaj wtedy bloki szeregowo
+ * zamiast czeka na wspln pul.
+ */
+void wylacz_rownoleglosc_watku(void);
+
+/**
+ * @brief Sprawdza, czy biecy wtek moe dzieli prac midzy wtki puli.
+ * @return false w wtkach puli, w trakcie ich zada oraz po wylacz_rownoleglosc_watku.
+ */
+bool rownoleglosc_watku(void);
@@ -0,0 +1,465 @@
+#include "wspolna.h"
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include "metryki.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+/**
+ * @brief Znacznik poprawnie zainicjowanego segmentu nagłówka ("Z4MW").
+ */
+static const unsigned int MAGIA = 0x574d345a;
+
+/**
+ * @struct naglowek_wspolny
+ * @brief Segment nagłówka: bieżąca wersja i rozmiar pod licznikiem sekwencji.
+ * Wydawca zmienia pola między dwoma zwiększeniami licznika; nieparzysty licznik oznacza zapis w toku.
+ */
+struct naglowek_wspolny {
+    atomic<unsigned int> magia; ///< MAGIA, zapisywana po zainicjowaniu pozostałych pól.
+    unsigned int format; ///< FORMAT_MACIERZY_WSPOLNEJ.
+    atomic<unsigned long long> sekwencja; ///< Licznik sekwencji (seqlock).
+    atomic<unsigned long long> wersja; ///< Numer bieżącej wersji (0 - brak).
+    atomic<long long> rozmiar; ///< Rozmiar bieżącej wersji.
+};
+
+static_assert(atomic<unsigned long long>::is_always_lock_free, "Atomowe liczniki w pamieci wspoldzielonej musza byc bezblokadowe");
+
+/**
+ * @brief Zwraca systemową nazwę segmentu.
+ * @param nazwa Nazwa segmentu.
+ * @return Nazwa z przedrostkiem wymaganym przez system.
+ */
+static string nazwa_systemowa(const string& nazwa)
+{
+#ifdef _WIN32
+    return "Local\\" + nazwa;
+#else
+    return "/" + nazwa;
+#endif
+}
+
+/**
+ * @brief Zwraca nazwę segmentu danych jednej wersji.
+ * @param nazwa Nazwa macierzy.
+ * @param wersja Numer wersji.
+ * @return Nazwa segmentu.
+ */
+static string nazwa_wersji(const string& nazwa, unsigned long long wersja)
+{
+    return nazwa + "." + to_string(wersja);
+}
+
+/**
+ * @brief Tworzy (lub otwiera) segment i mapuje go do zapisu.
+ * @param nazwa Nazwa segmentu.
+ * @param bajty Rozmiar segmentu.
+ * @param nowy true - segment musi powstać od nowa (pozostałość po przerwanym procesie jest usuwana; na Windows - błąd).
+ * @param uchwyt Uchwyt segmentu, który musi pozostać otwarty (tylko Windows).
+ * @return Początek mapowania lub nullptr.
+ */
+static void* utworz_segment(const string& nazwa, size_t bajty, bool nowy, void** uchwyt)
+{
+    string s = nazwa_systemowa(nazwa);
+#ifdef _WIN32
+    HANDLE h = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)((unsigned long long)bajty >> 32),
+        (DWORD)bajty, s.c_str());
+    if (h == nullptr || (nowy && GetLastError() == ERROR_ALREADY_EXISTS))
+    {
+        if (h != nullptr)
+        {
+            CloseHandle(h);
+        }
+        return nullptr;
+    }
+    void* p = MapViewOfFile(h, FILE_MAP_ALL_ACCESS, 0, 0, bajty);
+    if (p == nullptr)
+    {
+        CloseHandle(h);
+        return nullptr;
+    }
+    *uchwyt = h;
+    return p;
+#else
+    if (nowy)
+    {
+        shm_unlink(s.c_str());
+    }
+    int fd = shm_open(s.c_str(), O_CREAT | O_RDWR | (nowy ? O_EXCL : 0), 0644);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || ((size_t)st.st_size < bajty && ftruncate(fd, (off_t)bajty) != 0))
+    {
+        close(fd);
+        return nullptr;
+    }
+    void* p = mmap(nullptr, bajty, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return p == MAP_FAILED ? nullptr : p;
+#endif
+}
+
+/**
+ * @brief Otwiera istniejący segment i mapuje go tylko do odczytu.
+ * @param nazwa Nazwa segmentu.
+ * @param bajty Rozmiar mapowania.
+ * @return Początek mapowania lub nullptr, gdy segmentu nie ma.
+ */
+static void* otworz_segment(const string& nazwa, size_t& bajty)
+{
+    string s = nazwa_systemowa(nazwa);
+#ifdef _WIN32
+    HANDLE h = OpenFileMappingA(FILE_MAP_READ, FALSE, s.c_str());
+    if (h == nullptr)
+    {
+        return nullptr;
+    }
+    void* p = MapViewOfFile(h, FILE_MAP_READ, 0, 0, 0);
+    // Widok utrzymuje segment, więc uchwyt nie jest już potrzebny.
+    CloseHandle(h);
+    MEMORY_BASIC_INFORMATION info;
+    if (p == nullptr || VirtualQuery(p, &info, sizeof(info)) == 0)
+    {
+        return nullptr;
+    }
+    bajty = info.RegionSize;
+    return p;
+#else
+    int fd = shm_open(s.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    struct stat st;
+    void* p = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        bajty = (size_t)st.st_size;
+        p = mmap(nullptr, bajty, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    return p == MAP_FAILED ? nullptr : p;
+#endif
+}
+
+/**
+ * @brief Odmapowuje segment.
+ * @param baza Początek mapowania.
+ * @param bajty Rozmiar mapowania.
+ */
+static void odmapuj(const void* baza, size_t bajty)
+{
+#ifdef _WIN32
+    UnmapViewOfFile(baza);
+#else
+    munmap((void*)baza, bajty);
+#endif
+}
+
+/**
+ * @brief Usuwa segment z przestrzeni nazw (istniejące mapowania pozostają ważne).
+ * Na Windows segment znika sam po zamknięciu ostatniego uchwytu i widoku.
+ * @param nazwa Nazwa segmentu.
+ */
+static void usun_segment(const string& nazwa)
+{
+#ifndef _WIN32
+    shm_unlink(nazwa_systemowa(nazwa).c_str());
+#endif
+}
+
+/**
+ * @brief Zamyka uchwyt segmentu (tylko Windows).
+ * @param uchwyt Uchwyt lub nullptr.
+ */
+static void zamknij_uchwyt(void*& uchwyt)
+{
+#ifdef _WIN32
+    if (uchwyt != nullptr)
+    {
+        CloseHandle(uchwyt);
+    }
+#endif
+    uchwyt = nullptr;
+}
+
+/**
+ * @brief Otwiera lub tworzy segment nagłówka; numeracja wersji jest kontynuowana.
+ * @param nazwa Nazwa macierzy (bez ukośników).
+ */
+wydawca_macierzy::wydawca_macierzy(const string& nazwa)
+{
+    this->nazwa = nazwa;
+    naglowek = (naglowek_wspolny*)utworz_segment(nazwa, sizeof(naglowek_wspolny), false, &uchwyt_naglowka);
+    if (naglowek == nullptr)
+    {
+        cout << "Nie mozna utworzyc segmentu pamieci wspoldzielonej" << endl;
+        return;
+    }
+    if (naglowek->magia.load(memory_order_acquire) != MAGIA)
+    {
+        naglowek->format = FORMAT_MACIERZY_WSPOLNEJ;
+        naglowek->sekwencja.store(0, memory_order_relaxed);
+        naglowek->wersja.store(0, memory_order_relaxed);
+        naglowek->rozmiar.store(0, memory_order_relaxed);
+        naglowek->magia.store(MAGIA, memory_order_release);
+    }
+    else if (naglowek->format != FORMAT_MACIERZY_WSPOLNEJ)
+    {
+        cout << "Niezgodny format segmentu pamieci wspoldzielonej" << endl;
+        odmapuj(naglowek, sizeof(naglowek_wspolny));
+        zamknij_uchwyt(uchwyt_naglowka);
+        naglowek = nullptr;
+        return;
+    }
+    // Wydawca przerwany w trakcie zapisu zostawia nieparzysty licznik, który zatrzymałby czytelników.
+    unsigned long long s = naglowek->sekwencja.load(memory_order_relaxed);
+    if (s & 1)
+    {
+        naglowek->sekwencja.store(s + 1, memory_order_release);
+    }
+}
+
+/**
+ * @brief Odmapowuje nagłówek; opublikowana wersja pozostaje dostępna (poza Windows).
+ */
+wydawca_macierzy::~wydawca_macierzy(void)
+{
+    if (naglowek != nullptr)
+    {
+        odmapuj(naglowek, sizeof(naglowek_wspolny));
+    }
+    zamknij_uchwyt(uchwyt_danych);
+    zamknij_uchwyt(uchwyt_naglowka);
+}
+
+/**
+ * @brief Sprawdza, czy segment nagłówka został otwarty.
+ * @return true jeśli można publikować.
+ */
+bool wydawca_macierzy::gotowy(void) const
+{
+    return naglowek != nullptr;
+}
+
+/**
+ * @brief Kopiuje macierz do nowego segmentu i atomowo czyni ją bieżącą wersją.
+ * Dane są zapisane w całości przed zmianą nagłówka, a poprzednia wersja jest usuwana
+ * z przestrzeni nazw dopiero po niej, więc czytelnik zawsze widzi kompletną macierz.
+ * @param m Publikowana macierz.
+ * @return Numer nowej wersji lub 0 w razie błędu.
+ */
+unsigned long long wydawca_macierzy::opublikuj(const matrix& m)
+{
+    if (naglowek == nullptr)
+    {
+        cout << "Segment pamieci wspoldzielonej nie jest otwarty" << endl;
+        return 0;
+    }
+    int n = m.dlug == nullptr ? 0 : *m.dlug;
+    MIERZ_OPERACJE(OP_WSPOLNA, (long long)n * n * 2 * sizeof(int));
+    unsigned long long poprzednia = naglowek->wersja.load(memory_order_relaxed);
+    unsigned long long wersja = poprzednia + 1;
+    size_t bajty = bajty_bufora_wspolnego((size_t)n * n);
+    void* uchwyt = nullptr;
+    void* baza = utworz_segment(nazwa_wersji(nazwa, wersja), bajty, true, &uchwyt);
+    if (baza == nullptr)
+    {
+        cout << "Nie mozna utworzyc segmentu pamieci wspoldzielonej" << endl;
+        return 0;
+    }
+    int* dane = bufor_wspolny(baza, bajty, true);
+    for (int i = 0; i < n; i++)
+    {
+        memcpy(dane + (size_t)i * n, m.mac[i], (size_t)n * sizeof(int));
+    }
+    zwolnij_bufor(dane);
+
+    unsigned long long s = naglowek->sekwencja.load(memory_order_relaxed);
+    naglowek->sekwencja.store(s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    naglowek->wersja.store(wersja, memory_order_relaxed);
+    naglowek->rozmiar.store(n, memory_order_relaxed);
+    naglowek->sekwencja.store(s + 2, memory_order_release);
+
+    if (poprzednia != 0)
+    {
+        usun_segment(nazwa_wersji(nazwa, poprzednia));
+    }
+    zamknij_uchwyt(uchwyt_danych);
+    uchwyt_danych = uchwyt;
+    return wersja;
+}
+
+/**
+ * @brief Usuwa z przestrzeni nazw segment nagłówka i bieżącej wersji.
+ */
+void wydawca_macierzy::usun(void)
+{
+    if (naglowek != nullptr)
+    {
+        unsigned long long wersja = naglowek->wersja.load(memory_order_relaxed);
+        if (wersja != 0)
+        {
+            usun_segment(nazwa_wersji(nazwa, wersja));
+        }
+    }
+    usun_segment(nazwa);
+}
+
+/**
+ * @brief Otwiera segment nagłówka; gdy jeszcze nie istnieje, próbuje ponownie przy kolejnych wywołaniach.
+ * @param nazwa Nazwa macierzy (bez ukośników).
+ */
+czytelnik_macierzy::czytelnik_macierzy(const string& nazwa)
+{
+    this->nazwa = nazwa;
+    gotowy();
+}
+
+/**
+ * @brief Odmapowuje nagłówek; dołączone macierze pozostają ważne.
+ */
+czytelnik_macierzy::~czytelnik_macierzy(void)
+{
+    if (naglowek != nullptr)
+    {
+        odmapuj(naglowek, sizeof(naglowek_wspolny));
+    }
+}
+
+/**
+ * @brief Sprawdza, czy segment nagłówka jest otwarty.
+ * Nagłówek, którego wydawca jeszcze nie zainicjował, jest odmapowywany do następnej próby.
+ * @return true jeśli nagłówek jest zmapowany.
+ */
+bool czytelnik_macierzy::gotowy(void)
+{
+    if (naglowek != nullptr)
+    {
+        return true;
+    }
+    size_t bajty = 0;
+    const naglowek_wspolny* h = (const naglowek_wspolny*)otworz_segment(nazwa, bajty);
+    if (h == nullptr)
+    {
+        return false;
+    }
+    if (bajty < sizeof(naglowek_wspolny) || h->magia.load(memory_order_acquire) != MAGIA)
+    {
+        odmapuj(h, bajty);
+        return false;
+    }
+    if (h->format != FORMAT_MACIERZY_WSPOLNEJ)
+    {
+        cout << "Niezgodny format segmentu pamieci wspoldzielonej" << endl;
+        odmapuj(h, bajty);
+        return false;
+    }
+    naglowek = h;
+    return true;
+}
+
+/**
+ * @brief Odczytuje spójną parę (wersja, rozmiar) z nagłówka.
+ * Odczyt jest powtarzany, dopóki licznik sekwencji jest nieparzysty lub zmienił się w jego trakcie.
+ * @param n Rozmiar bieżącej wersji.
+ * @return Numer bieżącej wersji (0 - brak).
+ */
+unsigned long long czytelnik_macierzy::odczytaj(int& n) const
+{
+    for (;;)
+    {
+        unsigned long long s = naglowek->sekwencja.load(memory_order_acquire);
+        if (s & 1)
+        {
+            this_thread::yield();
+            continue;
+        }
+        unsigned long long wersja = naglowek->wersja.load(memory_order_relaxed);
+        long long rozmiar = naglowek->rozmiar.load(memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        if (naglowek->sekwencja.load(memory_order_relaxed) == s)
+        {
+            n = (int)rozmiar;
+            return wersja;
+        }
+    }
+}
+
+/**
+ * @brief Zwraca numer bieżącej wersji bez mapowania danych (tani test, czy dołączyć ponownie).
+ * @return Numer wersji (0 - nic nie opublikowano).
+ */
+unsigned long long czytelnik_macierzy::wersja(void)
+{
+    if (!gotowy())
+    {
+        return 0;
+    }
+    int n;
+    return odczytaj(n);
+}
+
+/**
+ * @brief Dołącza bieżącą wersję do macierzy m bez kopiowania danych.
+ * Gdy wydawca zdąży opublikować kolejną wersję i usunąć odczytaną, odczyt jest ponawiany.
+ * Macierz jest tylko do odczytu: pierwszy zapis tworzy jej prywatną kopię.
+ * @param m Macierz docelowa.
+ * @return Numer dołączonej wersji lub 0, gdy nic nie opublikowano.
+ */
+unsigned long long czytelnik_macierzy::dolacz(matrix& m)
+{
+    if (!gotowy())
+    {
+        return 0;
+    }
+    for (;;)
+    {
+        int n;
+        unsigned long long wersja = odczytaj(n);
+        if (wersja == 0)
+        {
+            return 0;
+        }
+        size_t bajty = 0;
+        void* baza = otworz_segment(nazwa_wersji(nazwa, wersja), bajty);
+        if (baza == nullptr)
+        {
+            if (odczytaj(n) == wersja)
+            {
+                cout << "Brak segmentu biezacej wersji macierzy" << endl;
+                return 0;
+            }
+            continue;
+        }
+        int* dane = bufor_wspolny(baza, bajty, false);
+        if (dane == nullptr || bajty < bajty_bufora_wspolnego((size_t)n * n))
+        {
+            cout << "Niezgodny format segmentu pamieci wspoldzielonej" << endl;
+            if (dane != nullptr)
+            {
+                zwolnij_bufor(dane);
+            }
+            else
+            {
+                odmapuj(baza, bajty);
+            }
+            return 0;
+        }
+        m.przejmij_do_odczytu(dane, n);
+        return wersja;
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <string>
+#include "matrix.h"
+using namespace std;
+
+/**
+ * @file wspolna.h
+ * @brief Macierze publikowane w pamici wspdzielonej dla wielu procesw bez kopiowania.
+ *
+ * Wydawca zapisuje kad wersj macierzy w osobnym segmencie "nazwa.wersja", a w segmencie
+ * nagwka "nazwa" podaje numer biecej wersji i rozmiar, chronione licznikiem sekwencji
+ * (seqlock). Czytelnicy mapuj segment wersji tylko do odczytu, wic strony danych istniej
+ * w pamici jeden raz niezalenie od liczby procesw. Po opublikowaniu nowej wersji stary
+ * segment jest usuwany z przestrzeni nazw, ale doczeni czytelnicy zachowuj go do odmapowania.
+ * Na Windows segmenty istniej, dopki ma je otwarte wydawca lub ktry czytelnik.
+ */
+
+/**
+ * @brief Wersja ukadu segmentu nagwka; czytelnik odrzuca segmenty innej wersji.
+ */
+const unsigned int FORMAT_MACIERZY_WSPOLNEJ = 1;
+
+struct naglowek_wspolny;
+
+/**
+ * @class wydawca_macierzy
+ * @brief Publikuje kolejne wersje macierzy pod jedn nazw (jeden wydawca na nazw).
+ */
+class wydawca_macierzy {
+private:
+    string nazwa; ///< Nazwa segmentu nagwka.
+    naglowek_wspolny* naglowek = nullptr; ///< Zmapowany segment nagwka.
+    void* uchwyt_naglowka = nullptr; ///< Uchwyt segmentu nagwka (tylko Windows).
+    void* uchwyt_danych = nullptr; ///< Uchwyt segmentu biecej wersji (tylko Windows).
+
+public:
+    /**
+     * @brief Otwiera lub tworzy segment nagwka; numeracja wersji jest kontynuowana.
+     * @param nazwa Nazwa macierzy (bez ukonikw).
+     */
+    wydawca_macierzy(const string& nazwa);
+
+    wydawca_macierzy(const wydawca_macierzy&) = delete;
+    wydawca_macierzy& operator=(const wydawca_macierzy&) = delete;
+
+    /**
+     * @brief Odmapowuje nagwek; opublikowana wersja pozostaje dostpna (poza Windows).
+     */
+    ~wydawca_macierzy(void);
+
+    /**
+     * @brief Sprawdza, czy segment nagwka zosta otwarty.
+     * @return true jeli mona publikowa.
+     */
+    bool gotowy(void) const;
+
+    /**
+     * @brief Kopiuje macierz do nowego segmentu i atomowo czyni j biec wersj.
+     * @param m Publikowana macierz.
+     * @return Numer nowej wersji lub 0 w razie bdu.
+     */
+    unsigned long long opublikuj(const matrix& m);
+
+    /**
+     * @brief Usuwa z przestrzeni nazw segment nagwka i biecej wersji.
+     */
+    void usun(void);
+};
+
+/**
+ * @class czytelnik_macierzy
+ * @brief Docza macierze opublikowane przez wydawca_macierzy, take w innym procesie.
+ */
+class czytelnik_macierzy {
+private:
+    string nazwa; ///< Nazwa segmentu nagwka.
+    const naglowek_wspolny* naglowek = nullptr; ///< Zmapowany (tylko do odczytu) segment nagwka.
+
+    /**
+     * @brief Odczytuje spjn par (wersja, rozmiar) z nagwka.
+     * @param n Rozmiar biecej wersji.
+     * @return Numer biecej wersji (0 - brak).
+     */
+    unsigned long long odczytaj(int& n) const;
+
+public:
+    /**
+     * @brief Otwiera segment nagwka; gdy jeszcze nie istnieje, prbuje ponownie przy kolejnych wywoaniach.
+     * @param nazwa Nazwa macierzy (bez ukonikw).
+     */
+    czytelnik_macierzy(const string& nazwa);
+
+    czytelnik_macierzy(const czytelnik_macierzy&) = delete;
+    czytelnik_macierzy& operator=(const czytelnik_macierzy&) = delete;
+
+    /**
+     * @brief Odmapowuje nagwek; doczone macierze pozostaj wane.
+     */
+    ~czytelnik_macierzy(void);
+
+    /**
+     * @brief Sprawdza, czy segment nagwka jest otwarty.
+     * @return true jeli nagwek jest zmapowany.
+     */
+    bool gotowy(void);
+
+    /**
+     * @brief Zwraca numer biecej wersji bez mapowania danych (tani test, czy doczy ponownie).
+     * @return Numer wersji (0 - nic nie opublikowano).
+     */
+    unsigned long long wersja(void);
+
+    /**
+     * @brief Docza biec wersj do macierzy m bez kopiowania danych.
+     * Macierz jest tylko do odczytu: pierwszy zapis tworzy jej prywatn kopi.
+     * @param m Macierz docelowa.
+     * @return Numer doczonej wersji lub 0, gdy nic nie opublikowano.
+     */
+    unsigned long long dolacz(matrix& m);
+};
@@ -0,0 +1,265 @@
+#include "wzorcowa.h"
+#include <iostream>
+#include <ostream>
+#include <vector>
+#include "watki.h"
+using namespace std;
+
+/**
+ * @brief Tworzy macierz wzorcową o rozmiarze n x n.
+ * Wzorzec WZOR_DIAGONALNA_K wymaga wartości przekątnej, więc jest odrzucany
+ * i zastępowany macierzą zerową.
+ * @param n Rozmiar macierzy.
+ * @param wzor Rodzaj wzorca (bez WZOR_DIAGONALNA_K).
+ */
+macierz_wzorcowa::macierz_wzorcowa(int n, wzorzec wzor)
+{
+    this->n = n;
+    this->wzor = wzor;
+    this->k = 0;
+    if (wzor == WZOR_DIAGONALNA_K)
+    {
+        cout << "Wzorzec diagonalny wymaga wartosci przekatnej" << endl;
+        this->t.assign(n, 0);
+    }
+}
+
+/**
+ * @brief Tworzy macierz z wartościami t[j] na przekątnej j - i = k, a zerami poza nią.
+ * @param n Rozmiar macierzy.
+ * @param k Przesunięcie przekątnej.
+ * @param t Tablica n wartości indeksowana numerem kolumny.
+ */
+macierz_wzorcowa::macierz_wzorcowa(int n, int k, int* t)
+{
+    this->n = n;
+    this->wzor = WZOR_DIAGONALNA_K;
+    this->k = k;
+    this->t.assign(t, t + n);
+}
+
+/**
+ * @brief Zwraca rozmiar macierzy.
+ * @return Rozmiar n.
+ */
+int macierz_wzorcowa::rozmiar(void) const
+{
+    return n;
+}
+
+/**
+ * @brief Zapisuje pełną postać macierzy do m (m musi mieć rozmiar n).
+ * @param m Macierz docelowa.
+ */
+void macierz_wzorcowa::materializuj(matrix& m) const
+{
+    if (*m.dlug != n)
+    {
+        cout << "Macierze posiadaja rozne dlugosci" << endl;
+        return;
+    }
+    m.odlacz();
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int i = poczatek; i < koniec; i++)
+        {
+            int* w = m.mac[i];
+            for (int j = 0; j < n; j++)
+            {
+                w[j] = pokaz(i, j);
+            }
+        }
+    });
+}
+
+/**
+ * @brief Dodaje macierz wzorcową do m: m = m + this.
+ * Wzorce przekątniowe zmieniają tylko n elementów, pozostałe jeden przebieg po m.
+ * @param m Macierz, do której dodawany jest wzorzec.
+ */
+void macierz_wzorcowa::dodaj_do(matrix& m) const
+{
+    if (*m.dlug != n)
+    {
+        cout << "Macierze posiadaja rozne dlugosci" << endl;
+        return;
+    }
+    m.odlacz();
+    if (wzor == WZOR_PRZEKATNA || wzor == WZOR_DIAGONALNA_K)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            int j = wzor == WZOR_PRZEKATNA ? i : i + k;
+            if (j >= 0 && j < n)
+            {
+                m.mac[i][j] = (int)((unsigned int)m.mac[i][j] + (unsigned int)pokaz(i, j));
+            }
+        }
+        return;
+    }
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int i = poczatek; i < koniec; i++)
+        {
+            unsigned int* w = (unsigned int*)m.mac[i];
+            if (wzor == WZOR_SZACHOWNICA)
+            {
+                for (int j = 0; j < n; j++)
+                {
+                    w[j] += (i + j) & 1;
+                }
+            }
+            else
+            {
+                int p = wzor == WZOR_POD_PRZEKATNA ? 0 : i + 1;
+                int q = wzor == WZOR_POD_PRZEKATNA ? i : n;
+                for (int j = p; j < q; j++)
+                {
+                    w[j] += 1;
+                }
+            }
+        }
+    });
+}
+
+/**
+ * @brief Mnoży z lewej strony: m = this * m.
+ * Wiersz i wyniku jest sumą wybranych wierszy m: prefiksową (pod przekątną),
+ * sufiksową (nad przekątną), sumą wierszy o przeciwnej parzystości (szachownica)
+ * lub przeskalowanym wierszem i + k (przekątna). Bloki kolumn są niezależne
+ * i wykonywane równolegle.
+ * @param m Macierz mnożona, nadpisywana wynikiem.
+ */
+void macierz_wzorcowa::mnoz_z_lewej(matrix& m) const
+{
+    if (*m.dlug != n)
+    {
+        cout << "Macierze posiadaja rozne dlugosci" << endl;
+        return;
+    }
+    m.odlacz();
+    if (wzor == WZOR_PRZEKATNA)
+    {
+        return;
+    }
+    rownolegle(n, (long long)n * n, [&](int blok, int c0, int c1) {
+        int szer = c1 - c0;
+        vector<unsigned int> suma(szer);
+        vector<unsigned int> druga(szer);
+        if (wzor == WZOR_POD_PRZEKATNA || wzor == WZOR_NAD_PRZEKATNA)
+        {
+            for (int s = 0; s < n; s++)
+            {
+                int i = wzor == WZOR_POD_PRZEKATNA ? s : n - 1 - s;
+                unsigned int* w = (unsigned int*)m.mac[i] + c0;
+                for (int j = 0; j < szer; j++)
+                {
+                    unsigned int stary = w[j];
+                    w[j] = suma[j];
+                    suma[j] += stary;
+                }
+            }
+        }
+        else if (wzor == WZOR_SZACHOWNICA)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                const unsigned int* w = (const unsigned int*)m.mac[i] + c0;
+                vector<unsigned int>& cel = (i & 1) ? druga : suma;
+                for (int j = 0; j < szer; j++)
+                {
+                    cel[j] += w[j];
+                }
+            }
+            for (int i = 0; i < n; i++)
+            {
+                unsigned int* w = (unsigned int*)m.mac[i] + c0;
+                const vector<unsigned int>& zrodlo = (i & 1) ? suma : druga;
+                for (int j = 0; j < szer; j++)
+                {
+                    w[j] = zrodlo[j];
+                }
+            }
+        }
+        else
+        {
+            for (int s = 0; s < n; s++)
+            {
+                int i = k > 0 ? s : n - 1 - s;
+                unsigned int* w = (unsigned int*)m.mac[i] + c0;
+                int z = i + k;
+                if (z < 0 || z >= n)
+                {
+                    for (int j = 0; j < szer; j++)
+                    {
+                        w[j] = 0;
+                    }
+                    continue;
+                }
+                unsigned int a = t[z];
+                const unsigned int* v = (const unsigned int*)m.mac[z] + c0;
+                for (int j = 0; j < szer; j++)
+                {
+                    w[j] = a * v[j];
+                }
+            }
+        }
+    });
+}
+
+/**
+ * @brief Mnoży z prawej strony: m = m * this.
+ * Każdy wiersz m jest przekształcany niezależnie: sumą sufiksową (pod przekątną),
+ * prefiksową (nad przekątną), sumami kolumn parzystych i nieparzystych (szachownica)
+ * lub przesunięciem o k z przeskalowaniem (przekątna).
+ * @param m Macierz mnożona, nadpisywana wynikiem.
+ */
+void macierz_wzorcowa::mnoz_z_prawej(matrix& m) const
+{
+    if (*m.dlug != n)
+    {
+        cout << "Macierze posiadaja rozne dlugosci" << endl;
+        return;
+    }
+    m.odlacz();
+    if (wzor == WZOR_PRZEKATNA)
+    {
+        return;
+    }
+    rownolegle(n, (long long)n * n, [&](int blok, int poczatek, int koniec) {
+        for (int i = poczatek; i < koniec; i++)
+        {
+            unsigned int* w = (unsigned int*)m.mac[i];
+            if (wzor == WZOR_POD_PRZEKATNA || wzor == WZOR_NAD_PRZEKATNA)
+            {
+                unsigned int suma = 0;
+                for (int s = 0; s < n; s++)
+                {
+                    int j = wzor == WZOR_NAD_PRZEKATNA ? s : n - 1 - s;
+                    unsigned int stary = w[j];
+                    w[j] = suma;
+                    suma += stary;
+                }
+            }
+            else if (wzor == WZOR_SZACHOWNICA)
+            {
+                unsigned int sumy[2] = { 0, 0 };
+                for (int j = 0; j < n; j++)
+                {
+                    sumy[j & 1] += w[j];
+                }
+                for (int j = 0; j < n; j++)
+                {
+                    w[j] = sumy[(j & 1) ^ 1];
+                }
+            }
+            else
+            {
+                for (int s = 0; s < n; s++)
+                {
+                    int j = k > 0 ? n - 1 - s : s;
+                    int z = j - k;
+                    w[j] = (z < 0 || z >= n) ? 0 : (unsigned int)t[j] * w[z];
+                }
+            }
+        }
+    });
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <iostream>
+#include <ostream>
+#include <vector>
+#include "matrix.h"
+using namespace std;
+
+/**
+ * @brief Wzorzec generowanej macierzy (odpowiedniki metod wypeniajcych klasy matrix).
+ */
+enum wzorzec {
+    WZOR_PRZEKATNA,      ///< Jedynki na przektnej (matrix::przekatna).
+    WZOR_POD_PRZEKATNA,  ///< Jedynki pod przektn (matrix::pod_przekatna).
+    WZOR_NAD_PRZEKATNA,  ///< Jedynki nad przektn (matrix::nad_przekatna).
+    WZOR_SZACHOWNICA,    ///< Jedynki tam, gdzie i + j jest nieparzyste (matrix::szachownica).
+    WZOR_DIAGONALNA_K    ///< Wartoci t[j] na przektnej j - i = k (matrix::diagonalna_k).
+};
+
+/**
+ * @class macierz_wzorcowa
+ * @brief Macierz, ktrej elementy s obliczane z pozycji (i, j) zamiast przechowywania n x n liczb.
+ *
+ * Zajmuje O(1) pamici (O(n) dla diagonalna_k). Dodawanie i mnoenie ze zwyk macierz
+ * czytaj z pamici tylko j, a dziki znanej strukturze wzorca mnoenie wykonuje si
+ * w czasie O(n^2) zamiast O(n^3).
+ */
+class macierz_wzorcowa {
+private:
+    int n; ///< Rozmiar macierzy.
+    wzorzec wzor; ///< Rodzaj wzorca.
+    int k; ///< Przesunicie przektnej (tylko WZOR_DIAGONALNA_K).
+    vector<int> t; ///< Wartoci przektnej indeksowane kolumn (tylko WZOR_DIAGONALNA_K).
+
+public:
+    /**
+     * @brief Tworzy macierz wzorcow o rozmiarze n x n.
+     * Wzorzec WZOR_DIAGONALNA_K wymaga wartoci przektnej, wic jest odrzucany
+     * i zastpowany macierz zerow.
+     * @param n Rozmiar macierzy.
+     * @param wzor Rodzaj wzorca (bez WZOR_DIAGONALNA_K).
+     */
+    macierz_wzorcowa(int n, wzorzec wzor);
+
+    /**
+     * @brief Tworzy macierz z wartociami t[j] na przektnej j - i = k, a zerami poza ni.
+     * @param n Rozmiar macierzy.
+     * @param k Przesunicie przektnej.
+     * @param t Tablica n wartoci indeksowana numerem kolumny.
+     */
+    macierz_wzorcowa(int n, int k, int* t);
+
+    /**
+     * @brief Zwraca rozmiar macierzy.
+     * @return Rozmiar n.
+     */
+    int rozmiar(void) const;
+
+    /**
+     * @brief Zwraca warto z okrelonej pozycji, obliczon ze wzorca.
+     * @param x Wiersz.
+     * @param y Kolumna.
+     * @return Warto elementu.
+     */
+    int pokaz(int x, int y) const
+    {
+        switch (wzor)
+        {
+        case WZOR_PRZEKATNA:
+            return x == y ? 1 : 0;
+        case WZOR_POD_PRZEKATNA:
+            return x > y ? 1 : 0;
+        case WZOR_NAD_PRZEKATNA:
+            return x < y ? 1 : 0;
+        case WZOR_SZACHOWNICA:
+            return (x + y) & 1;
+        default:
+            return y - x == k ? t[y] : 0;
+        }
+    }
+
+    /**
+     * @brief Zapisuje pen posta macierzy do m (m musi mie rozmiar n).
+     * @param m Macierz docelowa.
+     */
+    void materializuj(matrix& m) const;
+
+    /**
+     * @brief Dodaje macierz wzorcow do m: m = m + this.
+     * @param m Macierz, do ktrej dodawany jest wzorzec.
+     */
+    void dodaj_do(matrix& m) const;
+
+    /**
+     * @brief Mnoy z lewej strony: m = this * m.
+     * @param m Macierz mnoona, nadpisywana wynikiem.
+     */
+    void mnoz_z_lewej(matrix& m) const;
+
+    /**
+     * @brief Mnoy z prawej strony: m = m * this.
+     * @param m Macierz mnoona, nadpisywana wynikiem.
+     */
+    void mnoz_z_prawej(matrix& m) const;
+};